@@ -9,10 +9,12 @@ boost::uuids::random_generator application_request_context::new_uuid;
 
 application_request_context::application_request_context (
 		const object_access_parameters& oap,
-		const request_failure_parameters& rfp)
+		const request_failure_parameters& rfp,
+		std::size_t priority_class)
   :	access_overrides(oap)
   ,	request_failure_defaults(rfp)
   ,	request_id(new_uuid())
+  ,	priority_class(priority_class)
 {	}
 
 
@@ -34,7 +34,8 @@ struct application_request_context
 {
 	application_request_context (
 			const object_access_parameters& oap,
-			const request_failure_parameters& rfp);
+			const request_failure_parameters& rfp,
+			std::size_t priority_class = 0);
 
 	~application_request_context ();
 	
@@ -42,6 +43,9 @@ struct application_request_context
 	const request_failure_parameters request_failure_defaults;
 	const boost::uuids::uuid request_id;
 
+	/*! Picks, among the client's delivery providers, the one through which the request is sent. */
+	const std::size_t priority_class;
+
 	/*!
 	 * Produces a request context with a new request-id label. Meant to allow the code to
 	 * distinguish wire requests that are the result of *automatic* behavior of the riak
@@ -49,7 +53,7 @@ struct application_request_context
 	 * parameters of the requests remain the same.
 	 */
 	application_request_context copy_with_new_request_id () const {
-		return application_request_context(this->access_overrides, this->request_failure_defaults);
+		return application_request_context(this->access_overrides, this->request_failure_defaults, this->priority_class);
 	}
 
 #	if RIAK_CPP_LOGGING_ENABLED
@@ -1,6 +1,13 @@
 #include <riak/application_request_context.hxx>
 #include <riak/client.hxx>
 #include <riak/request_with_timeout.hxx>
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
 
 //=============================================================================
 namespace riak {
@@ -18,7 +25,10 @@ const object_access_parameters client::access_override_defaults = object_access_
 
 const request_failure_parameters client::failure_defaults = request_failure_parameters()
     .with_response_timeout(std::chrono::milliseconds(3000))
-    .with_retries_permitted(1);
+    .with_retries_permitted(1)
+    .with_retry_backoff(std::chrono::milliseconds(50))
+    .with_request_deadline(std::chrono::milliseconds(10000))
+    .with_hedge_percentile(0);
 
 
 class client::request_runner
@@ -30,6 +40,7 @@ class client::request_runner
     request_runner (client& client, const application_request_context&& application_context)
       : client_(client)
       , request_context_(std::move(application_context))
+      , runs_batch_(false)
     {   }
 
     application_request_context::automatic_record_ostream<decltype(client::log_)> log (
@@ -44,8 +55,25 @@ class client::request_runner
 
     void run_get_request (KV_COMMON_PARAMS, get_response_handler&);
 
-    bool accept_get_response (KV_COMMON_PARAMS, get_response_handler,
-            const std::error_code&, std::size_t, const std::string&);
+    /*!
+     * Fetches each of the given keys, keeping at most concurrency GETs in flight. All GETs share
+     * this runner and its request context.
+     */
+    void run_get_batch (const key& bucket, const std::vector<key>& keys, keyed_get_response_handler, batch_completion_handler, std::size_t concurrency);
+
+    /*! As run_get_batch, but stores each value under its key with no vector clock. */
+    void run_put_batch (const key& bucket, const std::vector<std::pair<key, std::shared_ptr<object>>>&, keyed_put_response_handler, batch_completion_handler, std::size_t concurrency);
+
+    /*! \param known is the vector clock of the cached object the GET was made conditional upon. */
+    bool accept_get_response (KV_COMMON_PARAMS, const boost::optional<vector_clock>& known, get_response_handler,
+            const std::error_code&, std::size_t, const char*);
+
+    /*!
+     * Hands the content of a GET or PUT response to the application, resolving siblings first.
+     * \param has_values is false for responses carrying only metadata, which are not cached.
+     */
+    template <typename ResponseType>
+    void deliver_content (KV_COMMON_PARAMS, ResponseType&, get_response_handler, bool has_values = true);
 
     template <typename ResponseType>
     void resolve_siblings_and_put (KV_COMMON_PARAMS, const ResponseType&, get_response_handler);
@@ -57,6 +85,18 @@ class client::request_runner
             const std::shared_ptr<object>&,
             put_response_handler);
 
+    /*! As put_with_vclock, but the stored object is returned as from a GET. */
+    void put_returning (
+            const key& bucket,
+            const key& k,
+            const boost::optional<vector_clock>&,
+            const std::shared_ptr<object>&,
+            put_returns,
+            get_response_handler);
+
+    bool accept_put_returning_response (KV_COMMON_PARAMS, put_returns, get_response_handler,
+            const std::error_code&, std::size_t, const char*);
+
     void put_resolved_sibling (
             const key& bucket,
             const key& k,
@@ -70,7 +110,7 @@ class client::request_runner
             get_response_handler,
             const std::error_code&,
             std::size_t,
-            const std::string&);
+            const char*);
 
     #undef KV_COMMON_PARAMS
 
@@ -78,19 +118,122 @@ class client::request_runner
             put_response_handler respond_to_application,
             const std::error_code& error,
             std::size_t bytes_received,
-            const std::string& data);
+            const char* data);
+
+    bool accept_head_response (
+            head_response_handler respond_to_application,
+            const std::error_code& error,
+            std::size_t bytes_received,
+            const char* data);
 
     bool accept_delete_response (
             delete_response_handler respond_to_application,
             const std::error_code& error,
             std::size_t bytes_received,
-            const std::string& data);
+            const char* data);
+
+    bool accept_list_keys_response (
+            key_batch_handler deliver_keys,
+            key_listing_completion_handler respond_to_application,
+            const std::error_code& error,
+            std::size_t bytes_received,
+            const char* data);
+
+    /*!
+     * Sends the given request. If it may safely be repeated, failures of the network or server to
+     * respond are retried as the request's failure parameters permit. Otherwise, and once retries
+     * are exhausted, they are reported to the handler.
+     *
+     * \param latencies, if given, records the response times of requests of this kind. The request
+     *     may then be hedged as the failure parameters prescribe; it must be idempotent.
+     */
+    void send_request (std::string wire_data, message::handler, bool idempotent, latency_tracker* latencies = nullptr);
 
   private:
+    struct request_attempts;
+    struct request_batch;
+    typedef std::shared_ptr<boost::asio::deadline_timer> shared_timer;
+
     client& client_;
     const application_request_context request_context_;
+    /*! Set once this runner starts a batch, whose keys then share its context. */
+    bool runs_batch_;
 
     void send_put_request (const RpbPutReq&, message::handler);
+    /*! The runner under which the application's later writes to a fetched key are sent. The keys of a
+        batch share its runner; any other request's writes get a context of their own. */
+    std::shared_ptr<request_runner> updating_runner ();
+    void run_next_requests (const std::shared_ptr<request_batch>&);
+    void finish_batched_request (const std::shared_ptr<request_batch>&);
+    void run_batched_get (const std::shared_ptr<request_batch>&, std::size_t index);
+    void accept_batched_get (const std::shared_ptr<request_batch>&, std::size_t index,
+            const std::error_code&, std::shared_ptr<object>&, value_updater);
+    void run_batched_put (const std::shared_ptr<request_batch>&, std::size_t index);
+    void accept_batched_put (const std::shared_ptr<request_batch>&, std::size_t index, const std::error_code&);
+    void send_attempt (const std::shared_ptr<request_attempts>&);
+    bool accept_or_retry (const std::shared_ptr<request_attempts>&, std::size_t attempt, const std::error_code&, std::size_t, const char*);
+    void retry (const std::shared_ptr<request_attempts>&, const shared_timer&, const boost::system::error_code&);
+    void hedge (const std::shared_ptr<request_attempts>&, const shared_timer&, const boost::system::error_code&);
+};
+
+
+/*!
+ * The progress of a run_get_batch or run_put_batch. Guarded by mutex, as requests of the batch
+ * may be answered concurrently.
+ */
+struct client::request_runner::request_batch
+{
+    boost::mutex mutex;
+
+    key bucket;
+    std::vector<key> keys;
+
+    /*! For a PUT batch, the value to store under each key. */
+    std::vector<std::shared_ptr<object>> values;
+
+    /*! Sends the request for the key at the given index. Its response must reach
+        finish_batched_request once the application has been told of it. */
+    std::function<void(const std::shared_ptr<request_batch>&, std::size_t)> run_request;
+
+    /*! Held here once, rather than by every request of the batch. Only the one matching the
+        batch's kind is set. */
+    keyed_get_response_handler on_get;
+    keyed_put_response_handler on_put;
+    batch_completion_handler on_completion;
+    std::size_t concurrency;
+
+    /*! The index of the first key not yet requested. */
+    std::size_t next_key;
+    std::size_t in_flight;
+};
+
+
+/*!
+ * What a request runner remembers of one request across all attempts to send it. Guarded by mutex,
+ * as hedged attempts may be answered concurrently.
+ */
+struct client::request_runner::request_attempts
+{
+    boost::mutex mutex;
+
+    /*! Held only while another attempt may follow. */
+    std::string wire_data;
+    message::handler handle_whole_response;
+    std::size_t retries_permitted;
+    std::size_t retries_made;
+    std::chrono::steady_clock::time_point started;
+    std::minstd_rand jitter;
+
+    /*! Indexed by attempt; an entry is reset once its attempt has ended or another has won. */
+    std::vector<std::shared_ptr<request_with_timeout>> in_flight;
+    std::vector<std::chrono::steady_clock::time_point> sent_at;
+
+    /*! The attempt whose response is used, once any has been answered successfully. */
+    boost::optional<std::size_t> answered_by;
+
+    latency_tracker* latencies;
+    boost::optional<std::chrono::milliseconds> hedge_delay;
+    shared_timer hedge_timer;
 };
 
 
@@ -99,22 +242,43 @@ client::client (
         const sibling_resolution&& sr,
         boost::asio::io_service& ios,
         const request_failure_parameters& fp,
-        const object_access_parameters& ao)
-  : deliver_request_(d),
+        const object_access_parameters& ao,
+        const std::shared_ptr<object_cache>& cache)
+  : deliver_request_(1, d),
     resolve_siblings_(sr),
     access_overrides_(ao),
     request_failure_defaults_(fp),
-    ios_(ios)
+    ios_(ios),
+    cache_(cache)
 {   }
 
 
-void client::delete_object (const key& bucket, const key& k, delete_response_handler h)
+client::client (
+        const std::vector<transport::delivery_provider>&& per_class,
+        const sibling_resolution&& sr,
+        boost::asio::io_service& ios,
+        const request_failure_parameters& fp,
+        const object_access_parameters& ao,
+        const std::shared_ptr<object_cache>& cache)
+  : deliver_request_(per_class),
+    resolve_siblings_(sr),
+    access_overrides_(ao),
+    request_failure_defaults_(fp),
+    ios_(ios),
+    cache_(cache)
+{
+    assert(not deliver_request_.empty());
+}
+
+
+void client::delete_object (const key& bucket, const key& k, delete_response_handler h, std::size_t priority_class)
 {
     assert(this);
+    assert(priority_class < deliver_request_.size());
     assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
     assert(not k.empty());       // TODO: if (not key.empty) ... else ...
 
-    application_request_context context(access_overrides_, request_failure_defaults_);
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
     context.log(log_) << "DELETE '" << bucket << "' / '" << k << '\'';
 
     auto runner = std::make_shared<request_runner>(*this, std::move(context));
@@ -131,14 +295,7 @@ void client::delete_object (const key& bucket, const key& k, delete_response_han
     if (overridden.pr)   request.set_pr(*overridden.pr);
     if (overridden.pw)   request.set_pw(*overridden.pw);
     auto query = message::encode(request);
-    auto handle_buffered_response = message::make_buffering_handler(handle_whole_response);
-    auto wire_request = std::make_shared<request_with_timeout>(
-            query.to_string(),
-            request_failure_defaults_.response_timeout,
-            handle_buffered_response,
-            ios_);
-    
-    wire_request->dispatch_via(deliver_request_);
+    runner->send_request(query.release(), handle_whole_response, /* idempotent */ true);
 }
 
 
@@ -146,7 +303,7 @@ bool client::request_runner::accept_delete_response (
         delete_response_handler respond_to_application,
         const std::error_code& error,
         std::size_t bytes_received,
-        const std::string& data)
+        const char* data)
 {
     if (not error) {
         log(log::severity::trace) << "Parsing server response ...";
@@ -168,13 +325,74 @@ bool client::request_runner::accept_delete_response (
 }
 
 
-void client::get_object (const key& bucket, const key& k, get_response_handler handle_get_result)
+void client::list_keys (
+        const key& bucket,
+        key_batch_handler on_keys,
+        key_listing_completion_handler on_done,
+        std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    context.log(log_) << "LIST KEYS '" << bucket << '\'';
+
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    message::handler handle_each_response = std::bind(&request_runner::accept_list_keys_response, runner, on_keys, on_done, _1, _2, _3);
+
+    RpbListKeysReq request;
+    request.set_bucket(bucket);
+    auto query = message::encode(request);
+
+    // Keys already handed to the application would be handed over again by a retry.
+    runner->send_request(query.release(), handle_each_response, /* idempotent */ false);
+}
+
+
+bool client::request_runner::accept_list_keys_response (
+        key_batch_handler deliver_keys,
+        key_listing_completion_handler respond_to_application,
+        const std::error_code& error,
+        std::size_t bytes_received,
+        const char* data)
+{
+    if (not error) {
+        RpbListKeysResp response;
+        if (message::retrieve(response, bytes_received, data)) {
+            if (response.keys_size() > 0) {
+                log(log::severity::trace) << "Received " << response.keys_size() << " keys.";
+                deliver_keys(response.keys());
+            }
+
+            // The server marks the last of its responses; until then, keep listening.
+            if (response.done()) {
+                log(log::severity::info) << "Key listing complete.";
+                respond_to_application(riak::make_error_code());
+            } else {
+                return false;
+            }
+        } else {
+            log(log::severity::error) << "Received something other than a key listing (parsing failed).";
+            respond_to_application(riak::make_error_code(communication_failure::unparseable_response));
+        }
+    } else {
+        log(log::severity::error) << "Request failed: " << error.message();
+        respond_to_application(error);
+    }
+
+    return true;
+}
+
+
+void client::get_object (const key& bucket, const key& k, get_response_handler handle_get_result, std::size_t priority_class)
 {
     assert(this);
+    assert(priority_class < deliver_request_.size());
     assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
     assert(not k.empty());       // TODO: if (not key.empty) ... else ...
     
-    application_request_context context(access_overrides_, request_failure_defaults_);
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
     context.log(log_) << "GET '" << bucket << "' / '" << k << '\'';
 
     auto runner = std::make_shared<request_runner>(*this, std::move(context));
@@ -182,23 +400,317 @@ void client::get_object (const key& bucket, const key& k, get_response_handler h
 }
 
 
+//=============================================================================
+    namespace {
+//=============================================================================
+
+RpbGetReq basic_get_request_for (
+        const key& bucket,
+        const key& k,
+        bool head,
+        const application_request_context&);
+
+//=============================================================================
+    }   //   namespace (anonymous)
+//=============================================================================
+
+void client::head_object (const key& bucket, const key& k, head_response_handler h, std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+    assert(not k.empty());       // TODO: if (not key.empty) ... else ...
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    context.log(log_) << "HEAD '" << bucket << "' / '" << k << '\'';
+    auto query = message::encode(basic_get_request_for(bucket, k, /* head */ true, context));
+
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    message::handler handle_whole_response = std::bind(&request_runner::accept_head_response, runner, h, _1, _2, _3);
+
+    // Response times of HEADs say little of those of GETs, so they are neither tracked nor hedged.
+    runner->send_request(query.release(), handle_whole_response, /* idempotent */ true);
+}
+
+
+bool client::request_runner::accept_head_response (
+        head_response_handler respond_to_application,
+        const std::error_code& error,
+        std::size_t bytes_received,
+        const char* data)
+{
+    object_head head;
+
+    if (not error) {
+        log(log::severity::trace) << "Parsing server response ...";
+
+        RpbGetResp response;
+        if (message::retrieve(response, bytes_received, data)) {
+            if (response.has_vclock())
+                head.vclock = response.vclock();
+            for (int i = 0; i < response.content_size(); ++i) {
+                auto sibling = std::make_shared<object>();
+                sibling->Swap(response.mutable_content(i));
+                head.siblings.push_back(sibling);
+            }
+
+            log(log::severity::info) << "Request successful (found " << head.siblings.size() << " siblings).";
+            respond_to_application(riak::make_error_code(), head);
+        } else {
+            log(log::severity::error) << "Received something other than a GET reply (parsing failed).";
+            respond_to_application(riak::make_error_code(communication_failure::unparseable_response), head);
+        }
+    } else {
+        log(log::severity::error) << "Request failed: " << error.message();
+        respond_to_application(error, head);
+    }
+
+    // Always terminate the request, whether success or failure.
+    return true;
+}
+
+
+void client::put_object (
+        const key& bucket,
+        const key& k,
+        const std::shared_ptr<object>& value,
+        const boost::optional<vector_clock>& vclock,
+        put_response_handler h,
+        std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+    assert(not k.empty());       // TODO: if (not key.empty) ... else ...
+    assert(!! value);
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    runner->put_with_vclock(bucket, k, vclock, value, h);
+}
+
+
+void client::put_object (
+        const key& bucket,
+        const key& k,
+        const std::shared_ptr<object>& value,
+        const boost::optional<vector_clock>& vclock,
+        put_returns returns,
+        get_response_handler h,
+        std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+    assert(not k.empty());       // TODO: if (not key.empty) ... else ...
+    assert(!! value);
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    runner->put_returning(bucket, k, vclock, value, returns, h);
+}
+
+
+void client::put_objects (
+        const key& bucket,
+        const std::vector<std::pair<key, std::shared_ptr<object>>>& values,
+        keyed_put_response_handler each,
+        batch_completion_handler done,
+        std::size_t concurrency,
+        std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+    assert(concurrency > 0);
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    context.log(log_) << "PUT " << values.size() << " keys of '" << bucket << '\'';
+
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    runner->run_put_batch(bucket, values, each, done, concurrency);
+}
+
+
+void client::get_objects (
+        const key& bucket,
+        const std::vector<key>& keys,
+        keyed_get_response_handler each,
+        batch_completion_handler done,
+        std::size_t concurrency,
+        std::size_t priority_class)
+{
+    assert(this);
+    assert(priority_class < deliver_request_.size());
+    assert(not bucket.empty());  // TODO: if (not bucket.empty) ... else ...
+    assert(concurrency > 0);
+
+    application_request_context context(access_overrides_, request_failure_defaults_, priority_class);
+    context.log(log_) << "GET " << keys.size() << " keys of '" << bucket << '\'';
+
+    auto runner = std::make_shared<request_runner>(*this, std::move(context));
+    runner->run_get_batch(bucket, keys, each, done, concurrency);
+}
+
+
+void client::request_runner::run_get_batch (
+        const key& bucket,
+        const std::vector<key>& keys,
+        keyed_get_response_handler respond_to_application,
+        batch_completion_handler on_completion,
+        std::size_t concurrency)
+{
+    runs_batch_ = true;
+    auto batch = std::make_shared<request_batch>();
+    batch->bucket = bucket;
+    batch->keys = keys;
+    batch->run_request = std::bind(&self::run_batched_get, shared_from_this(), _1, _2);
+    batch->on_get = respond_to_application;
+    batch->on_completion = on_completion;
+    batch->concurrency = concurrency;
+    batch->next_key = 0;
+    batch->in_flight = 0;
+    run_next_requests(batch);
+}
+
+
+void client::request_runner::run_put_batch (
+        const key& bucket,
+        const std::vector<std::pair<key, std::shared_ptr<object>>>& values,
+        keyed_put_response_handler respond_to_application,
+        batch_completion_handler on_completion,
+        std::size_t concurrency)
+{
+    runs_batch_ = true;
+    auto batch = std::make_shared<request_batch>();
+    batch->bucket = bucket;
+    batch->keys.reserve(values.size());
+    batch->values.reserve(values.size());
+    for (auto value = values.begin(); value != values.end(); ++value) {
+        batch->keys.push_back(value->first);
+        batch->values.push_back(value->second);
+    }
+    batch->run_request = std::bind(&self::run_batched_put, shared_from_this(), _1, _2);
+    batch->on_put = respond_to_application;
+    batch->on_completion = on_completion;
+    batch->concurrency = concurrency;
+    batch->next_key = 0;
+    batch->in_flight = 0;
+    run_next_requests(batch);
+}
+
+
+void client::request_runner::run_next_requests (const std::shared_ptr<request_batch>& batch)
+{
+    boost::unique_lock<boost::mutex> serialize(batch->mutex);
+    if (batch->keys.empty()) {
+        serialize.unlock();
+        batch->on_completion();
+        return;
+    }
+
+    std::size_t first = batch->next_key;
+    while (batch->in_flight < batch->concurrency and batch->next_key < batch->keys.size()) {
+        ++batch->in_flight;
+        ++batch->next_key;
+    }
+    std::size_t last = batch->next_key;
+    serialize.unlock();
+
+    // Responses may arrive on other threads before this loop completes; the keys claimed above
+    // are no longer touched by anyone else.
+    for (std::size_t index = first; index < last; ++index) {
+        assert(not batch->keys[index].empty());  // TODO: if (not key.empty) ... else ...
+        batch->run_request(batch, index);
+    }
+}
+
+
+void client::request_runner::finish_batched_request (const std::shared_ptr<request_batch>& batch)
+{
+    boost::unique_lock<boost::mutex> serialize(batch->mutex);
+    --batch->in_flight;
+    bool batch_finished = (batch->in_flight == 0 and batch->next_key == batch->keys.size());
+    serialize.unlock();
+
+    if (batch_finished) {
+        log(log::severity::info) << "All " << batch->keys.size() << " requests of the batch answered.";
+        batch->on_completion();
+    } else {
+        run_next_requests(batch);
+    }
+}
+
+
+void client::request_runner::run_batched_get (
+        const std::shared_ptr<request_batch>& batch,
+        std::size_t index)
+{
+    get_response_handler handle_get_result = std::bind(&self::accept_batched_get, shared_from_this(),
+            batch, index, /* error */ _1, /* object */ _2, /* updater */ _3);
+    try {
+        run_get_request(batch->bucket, batch->keys[index], client_.resolve_siblings_, handle_get_result);
+    } catch (const std::system_error& e) {
+        // The key is answered all the same, so that the batch still completes. The answer goes
+        // through ios, lest a halted transport fail the rest of the batch recursively from here.
+        log(log::severity::error) << "Request for '" << batch->keys[index] << "' could not be sent: " << e.what();
+        client_.ios_.post(std::bind(handle_get_result, e.code(), std::shared_ptr<object>(), value_updater()));
+    }
+}
+
+
+void client::request_runner::accept_batched_get (
+        const std::shared_ptr<request_batch>& batch,
+        std::size_t index,
+        const std::error_code& error,
+        std::shared_ptr<object>& content,
+        value_updater update_value)
+{
+    batch->on_get(batch->keys[index], error, content, update_value);
+    finish_batched_request(batch);
+}
+
+
+void client::request_runner::run_batched_put (
+        const std::shared_ptr<request_batch>& batch,
+        std::size_t index)
+{
+    put_response_handler handle_put_result = std::bind(&self::accept_batched_put, shared_from_this(),
+            batch, index, /* error */ _1);
+    try {
+        put_with_vclock(batch->bucket, batch->keys[index], boost::none, batch->values[index], handle_put_result);
+    } catch (const std::system_error& e) {
+        log(log::severity::error) << "Request for '" << batch->keys[index] << "' could not be sent: " << e.what();
+        client_.ios_.post(std::bind(handle_put_result, e.code()));
+    }
+}
+
+
+void client::request_runner::accept_batched_put (
+        const std::shared_ptr<request_batch>& batch,
+        std::size_t index,
+        const std::error_code& error)
+{
+    batch->on_put(batch->keys[index], error);
+    finish_batched_request(batch);
+}
+
+
 void client::request_runner::run_get_request (
         const key& bucket,
         const key& k,
         sibling_resolution& resolve_siblings,
         get_response_handler& handle_get_result)
 {
-    RpbGetReq request;
-    request.set_bucket(bucket);
-    request.set_key(k);
-    auto& overridden = request_context_.access_overrides;
-    if (overridden.r )            request.set_r           (*overridden.r);
-    if (overridden.pr)            request.set_pr          (*overridden.pr);
-    if (overridden.basic_quorum)  request.set_basic_quorum(*overridden.basic_quorum);
-    if (overridden.notfound_ok)   request.set_notfound_ok (*overridden.notfound_ok);
-    request.clear_if_modified();
-    request.set_head(false);
-    request.set_deletedvclock(true);
+    RpbGetReq request = basic_get_request_for(bucket, k, /* head */ false, request_context_);
+
+    boost::optional<vector_clock> known;
+    if (client_.cache_)
+        known = client_.cache_->lookup(bucket, k);
+    if (!! known)
+        request.set_if_modified(*known);
+    else
+        request.clear_if_modified();
     auto query = message::encode(request);
 
     message::handler handle_whole_response =
@@ -206,16 +718,10 @@ void client::request_runner::run_get_request (
                     shared_from_this(),
                     bucket, k,
                     resolve_siblings,
+                    known,
                     handle_get_result,
                     /* error */ _1, /* data size */ _2, /* data */ _3);
-    auto handle_buffered_response = message::make_buffering_handler(handle_whole_response);
-    auto wire_request = std::make_shared<request_with_timeout>(
-            query.to_string(),
-            request_context_.request_failure_defaults.response_timeout,
-            handle_buffered_response,
-            client_.ios_);
-    
-    wire_request->dispatch_via(client_.deliver_request_);
+    send_request(query.release(), handle_whole_response, /* idempotent */ true, &client_.get_latencies_);
 }
 
 //=============================================================================
@@ -231,7 +737,7 @@ RpbPutReq basic_put_request_for (
 typedef std::function <bool(std::shared_ptr<object>&,
                             const std::error_code&,
                             std::size_t,
-                            const std::string&)>
+                            const char*)>
         resolution_response_handler_for_object;
 
 message::handler make_resolution_response_handler (
@@ -249,62 +755,45 @@ bool client::request_runner::accept_get_response (
         const key& bucket,
         const key& k,
         sibling_resolution& resolve_siblings,
+        const boost::optional<vector_clock>& known,
         get_response_handler respond_to_application,
         const std::error_code& error,
         std::size_t bytes_received,
-        const std::string& data)
+        const char* data)
 {
     // A possible response in several cases.
     std::shared_ptr<object> no_content;
     value_updater no_value_updater;
-    std::function<void(const std::error_code&)> report_error = std::bind(respond_to_application, _1, no_content, no_value_updater);
 
     if (not error) {
         log(log::severity::trace) << "Parsing server response ...";
         assert(bytes_received != 0);
-        assert(bytes_received == data.size());
 
         RpbGetResp response;
-        if (message::retrieve(response, data.size(), data)) {
-            auto& old_context = request_context_;
-            auto new_request_runner = std::make_shared<request_runner>(client_, old_context.copy_with_new_request_id());
-            value_updater add_content = std::bind(&self::put_with_vclock, new_request_runner,
-                    bucket, k, boost::none, _1 /* object */, _2 /* response handler */);
-
-            if (response.content_size() > 1) {
-                if (response.has_vclock()) {
-                    log(log::severity::trace) << "Found " << response.content_size() << " siblings; attempting resolution.";
-                    resolve_siblings_and_put(bucket, k, resolve_siblings, response, respond_to_application);
-                } else {
-                    log(log::severity::error) << "Found " << response.content_size() << " siblings with no vector clock -- cannot resolve.";
-                    report_error(communication_failure::inappropriate_response_content);
-                }
-            } else if (response.content_size() == 1) {
-                std::shared_ptr<object> the_value(response.mutable_content()->ReleaseLast());
-
-                if (response.has_vclock()) {
-                    log(log::severity::info) << "GET successful (found object).";
-                    value_updater update_content = std::bind(&self::put_with_vclock, new_request_runner,
-                            bucket, k, response.vclock(), _1 /* object */, _2 /* response handler */);
-                    respond_to_application(riak::make_error_code(), the_value, update_content);
+        if (message::retrieve(response, bytes_received, data)) {
+            if (response.unchanged() and !! known) {
+                auto held = client_.cache_->revalidate(bucket, k, *known);
+                if (!! held) {
+                    log(log::severity::info) << "Request successful (cached object unchanged).";
+                    value_updater update_content = std::bind(&self::put_with_vclock, updating_runner(),
+                            bucket, k, *known, _1 /* object */, _2 /* response handler */);
+                    respond_to_application(riak::make_error_code(), held, update_content);
                 } else {
-                    log(log::severity::warning) << "Found 1 object with no vector clock -- storing to this index may create siblings.";
-                    respond_to_application(
-                            riak::make_error_code(communication_failure::missing_vector_clock),
-                            the_value,
-                            add_content /* Creates a sibling, probably. */);
+                    log(log::severity::trace) << "Cached object was evicted before it could be used. Fetching it whole ...";
+                    run_get_request(bucket, k, resolve_siblings, respond_to_application);
                 }
             } else {
-                log(log::severity::info) << "GET successful (no content).";
-                respond_to_application(riak::make_error_code(), no_content, add_content);
+                if (!! known)
+                    client_.cache_->forget(bucket, k);
+                deliver_content(bucket, k, resolve_siblings, response, respond_to_application);
             }
         } else {
             log(log::severity::error) << "Received a reply from the server that could not be decoded.";
-            report_error(communication_failure::unparseable_response);
+            respond_to_application(riak::make_error_code(communication_failure::unparseable_response), no_content, no_value_updater);
         }
     } else {
         log(log::severity::error) << "Request failed: " << error.message();
-        report_error(error);
+        respond_to_application(error, no_content, no_value_updater);
     }
 
     // Always terminate the request, whether success or failure.
@@ -312,6 +801,52 @@ bool client::request_runner::accept_get_response (
 }
 
 
+template <typename ResponseType>
+void client::request_runner::deliver_content (
+        const key& bucket,
+        const key& k,
+        sibling_resolution& resolve_siblings,
+        ResponseType& response,
+        get_response_handler respond_to_application,
+        bool has_values)
+{
+    std::shared_ptr<object> no_content;
+    auto runner = updating_runner();
+    value_updater add_content = std::bind(&self::put_with_vclock, runner,
+            bucket, k, boost::none, _1 /* object */, _2 /* response handler */);
+
+    if (response.content_size() > 1) {
+        if (response.has_vclock()) {
+            log(log::severity::trace) << "Found " << response.content_size() << " siblings; attempting resolution.";
+            resolve_siblings_and_put(bucket, k, resolve_siblings, response, respond_to_application);
+        } else {
+            log(log::severity::error) << "Found " << response.content_size() << " siblings with no vector clock -- cannot resolve.";
+            respond_to_application(riak::make_error_code(communication_failure::inappropriate_response_content), no_content, value_updater());
+        }
+    } else if (response.content_size() == 1) {
+        std::shared_ptr<object> the_value(response.mutable_content()->ReleaseLast());
+
+        if (response.has_vclock()) {
+            log(log::severity::info) << "Request successful (found object).";
+            if (client_.cache_ and has_values)
+                client_.cache_->store(bucket, k, *the_value, response.vclock());
+            value_updater update_content = std::bind(&self::put_with_vclock, runner,
+                    bucket, k, response.vclock(), _1 /* object */, _2 /* response handler */);
+            respond_to_application(riak::make_error_code(), the_value, update_content);
+        } else {
+            log(log::severity::warning) << "Found 1 object with no vector clock -- storing to this index may create siblings.";
+            respond_to_application(
+                    riak::make_error_code(communication_failure::missing_vector_clock),
+                    the_value,
+                    add_content /* Creates a sibling, probably. */);
+        }
+    } else {
+        log(log::severity::info) << "Request successful (no content).";
+        respond_to_application(riak::make_error_code(), no_content, add_content);
+    }
+}
+
+
 template <typename ResponseType>
 void client::request_runner::resolve_siblings_and_put (
         const key& bucket,
@@ -336,9 +871,7 @@ void client::request_runner::resolve_siblings_and_put (
     } else {
         log(log::severity::warning) << "Sibling resolution yielded NULL. Responding as for 'no content'.";
         auto& no_content = resolved_content;
-        auto& old_context = request_context_;
-        auto new_request_runner = std::make_shared<request_runner>(client_, old_context.copy_with_new_request_id());
-        value_updater add_content = std::bind(&self::put_with_vclock, new_request_runner,
+        value_updater add_content = std::bind(&self::put_with_vclock, updating_runner(),
                 bucket, k, boost::none, _1 /* object */, _2 /* response handler */);
 
         respond_to_application(riak::make_error_code(), no_content, add_content);
@@ -354,25 +887,27 @@ bool client::request_runner::return_successfully_resolved_sibling_or_retry (
         get_response_handler respond_to_application,
         const std::error_code& error,
         std::size_t bytes_received,
-        const std::string& data)
+        const char* data)
 {
     std::shared_ptr<object> no_content;
-    value_updater add_sibling = std::bind(&self::put_with_vclock, shared_from_this(),
+    auto runner = updating_runner();
+    value_updater add_sibling = std::bind(&self::put_with_vclock, runner,
             bucket, k, boost::none, /* object */ _1, /* put resp */ _2);
 
     if (not error) {
         log(log::severity::trace) << "Processing result of sibling resolution ...";
         assert(bytes_received != 0);
-        assert(bytes_received == data.size());
         
         RpbPutResp response;
-        if (message::retrieve(response, data.size(), data)) {
+        if (message::retrieve(response, bytes_received, data)) {
             if (response.content_size() == 1 and response.has_vclock()) {
-                value_updater put_new_value = std::bind(&self::put_with_vclock, shared_from_this(),
+                value_updater put_new_value = std::bind(&self::put_with_vclock, runner,
                         bucket, k, response.vclock(),
                         _1 /* new value */, _2 /* response_handler */);
 
                 log(log::severity::info) << "GET successful after applying sibling resolution.";
+                if (client_.cache_)
+                    client_.cache_->store(bucket, k, *cached_object, response.vclock());
                 respond_to_application(riak::make_error_code(), cached_object, put_new_value);
             } else {
                 log(log::severity::trace) << "Value collided again upon resolution. Fetching new siblings ...";
@@ -420,6 +955,81 @@ void client::request_runner::put_with_vclock (
 }
 
 
+void client::request_runner::put_returning (
+        const key& bucket,
+        const key& k,
+        const boost::optional<vector_clock>& vclock,
+        const std::shared_ptr<object>& content,
+        put_returns returns,
+        get_response_handler respond_to_application)
+{
+    log(log::severity::info) << "PUT '" << bucket << "' / '" << k << '\'';
+    RpbPutReq request = basic_put_request_for(bucket, k, content, request_context_);
+    if (!! vclock)
+        request.set_vclock(*vclock);
+
+    request.set_return_body(returns == put_returns::body);
+    request.set_if_not_modified(false);
+    request.set_if_none_match(false);
+    request.set_return_head(returns == put_returns::head);
+
+    message::handler handle_response = std::bind(&self::accept_put_returning_response, shared_from_this(),
+            bucket, k, std::ref(client_.resolve_siblings_), returns, respond_to_application,
+            /* error */ _1, /* size */ _2, /* payload */ _3);
+    send_put_request(request, handle_response);
+}
+
+
+bool client::request_runner::accept_put_returning_response (
+        const key& bucket,
+        const key& k,
+        sibling_resolution& resolve_siblings,
+        put_returns returns,
+        get_response_handler respond_to_application,
+        const std::error_code& error,
+        std::size_t bytes_received,
+        const char* data)
+{
+    std::shared_ptr<object> no_content;
+    value_updater no_value_updater;
+
+    if (not error) {
+        log(log::severity::trace) << "Parsing server response ...";
+
+        RpbPutResp response;
+        if (not message::retrieve(response, bytes_received, data)) {
+            log(log::severity::error) << "Received something other than a PUT reply (parsing failed).";
+            respond_to_application(riak::make_error_code(communication_failure::unparseable_response), no_content, no_value_updater);
+        } else if (returns == put_returns::head) {
+            // Whatever the cache holds for this key is now out of date, and a head cannot replace it.
+            if (client_.cache_)
+                client_.cache_->forget(bucket, k);
+
+            if (response.content_size() > 1) {
+                // Siblings cannot be resolved without their values. The vector clock covers them
+                // all, so a write through it replaces every sibling.
+                log(log::severity::warning) << "PUT created " << response.content_size() << " siblings; returning none of them.";
+                value_updater update_content;
+                if (response.has_vclock())
+                    update_content = std::bind(&self::put_with_vclock, updating_runner(),
+                            bucket, k, response.vclock(), _1 /* object */, _2 /* response handler */);
+                respond_to_application(riak::make_error_code(), no_content, update_content);
+            } else {
+                deliver_content(bucket, k, resolve_siblings, response, respond_to_application, /* has values */ false);
+            }
+        } else {
+            deliver_content(bucket, k, resolve_siblings, response, respond_to_application);
+        }
+    } else {
+        log(log::severity::error) << "Request failed: " << error.message();
+        respond_to_application(error, no_content, no_value_updater);
+    }
+
+    // Always terminate the request, whether success or failure.
+    return true;
+}
+
+
 void client::request_runner::put_resolved_sibling (
         const key& bucket,
         const key& k,
@@ -437,17 +1047,207 @@ void client::request_runner::put_resolved_sibling (
 }
 
 
+std::shared_ptr<client::request_runner> client::request_runner::updating_runner ()
+{
+    if (runs_batch_)
+        return shared_from_this();
+    return std::make_shared<request_runner>(client_, request_context_.copy_with_new_request_id());
+}
+
+
 void client::request_runner::send_put_request (const RpbPutReq& r, message::handler handle_whole_put_response)
 {
+    // A repeated PUT may create siblings, unless it is conditional. We leave that to the application.
     auto query = message::encode(r);
-    auto handle_buffered_put_response = message::make_buffering_handler(handle_whole_put_response);
+    send_request(query.release(), handle_whole_put_response, /* idempotent */ false);
+}
+
+
+void client::request_runner::send_request (
+        std::string wire_data,
+        message::handler h,
+        bool idempotent,
+        latency_tracker* latencies)
+{
+    auto& failure_parameters = request_context_.request_failure_defaults;
+    auto attempts = std::make_shared<request_attempts>();
+    attempts->wire_data = std::move(wire_data);
+    attempts->handle_whole_response = h;
+    attempts->retries_permitted = idempotent ? failure_parameters.retries_permitted : 0;
+    attempts->retries_made = 0;
+    attempts->started = std::chrono::steady_clock::now();
+    attempts->latencies = latencies;
+
+    // Seeding from the request id keeps the jitter of concurrent requests apart, without any
+    // generator being shared between threads.
+    attempts->jitter.seed(static_cast<std::minstd_rand::result_type>(boost::uuids::hash_value(request_context_.request_id)));
+
+    if (latencies and failure_parameters.hedge_percentile > 0) {
+        assert(idempotent);
+        attempts->hedge_delay = latencies->percentile(failure_parameters.hedge_percentile);
+        if (!! attempts->hedge_delay) {
+            attempts->hedge_timer = std::make_shared<boost::asio::deadline_timer>(client_.ios_);
+            attempts->hedge_timer->expires_from_now(boost::posix_time::milliseconds(attempts->hedge_delay->count()));
+            attempts->hedge_timer->async_wait(std::bind(&self::hedge, shared_from_this(), attempts, attempts->hedge_timer, _1));
+        }
+    }
+
+    send_attempt(attempts);
+}
+
+
+void client::request_runner::send_attempt (const std::shared_ptr<request_attempts>& attempts)
+{
+    boost::unique_lock<boost::mutex> serialize(attempts->mutex);
+    std::size_t attempt = attempts->in_flight.size();
+    message::handler handle_whole_response = std::bind(&self::accept_or_retry, shared_from_this(),
+            attempts, attempt, /* error */ _1, /* size */ _2, /* payload */ _3);
+    auto handle_buffered_response = message::make_buffering_handler(handle_whole_response);
+
+    // Keep a copy of the request only if another attempt may need it.
+    bool last_attempt = (attempts->retries_made >= attempts->retries_permitted)
+            and (not attempts->hedge_timer or attempt > 0);
+
+    // No attempt may wait for its response beyond the request's deadline. One sent with (next to)
+    // nothing left of it times out at once.
+    auto& failure_parameters = request_context_.request_failure_defaults;
+    auto response_timeout = failure_parameters.response_timeout;
+    if (failure_parameters.request_deadline.count() > 0) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                attempts->started + failure_parameters.request_deadline - std::chrono::steady_clock::now());
+        response_timeout = std::max(std::chrono::milliseconds(1), std::min(response_timeout, remaining));
+    }
+
     auto wire_request = std::make_shared<request_with_timeout>(
-            query.to_string(),
-            request_context_.request_failure_defaults.response_timeout,
-            handle_buffered_put_response,
+            last_attempt ? std::move(attempts->wire_data) : attempts->wire_data,
+            response_timeout,
+            handle_buffered_response,
             client_.ios_);
-    
-    wire_request->dispatch_via(client_.deliver_request_);
+    attempts->in_flight.push_back(wire_request);
+    attempts->sent_at.push_back(std::chrono::steady_clock::now());
+    serialize.unlock();
+
+    wire_request->dispatch_via(client_.deliver_request_[request_context_.priority_class]);
+}
+
+
+bool client::request_runner::accept_or_retry (
+        const std::shared_ptr<request_attempts>& attempts,
+        std::size_t attempt,
+        const std::error_code& error,
+        std::size_t bytes_received,
+        const char* data)
+{
+    boost::unique_lock<boost::mutex> serialize(attempts->mutex);
+
+    // Only one attempt may answer; the others run their course to no effect.
+    if (!! attempts->answered_by and *attempts->answered_by != attempt)
+        return true;
+
+    if (not error and not attempts->answered_by) {
+        attempts->answered_by = attempt;
+        if (attempts->latencies) {
+            auto response_time = std::chrono::steady_clock::now() - attempts->sent_at[attempt];
+            attempts->latencies->record(std::chrono::duration_cast<std::chrono::milliseconds>(response_time));
+        }
+
+        // The others are left to finish. One already written may share its connection with
+        // unrelated requests, which terminating it dirty would fail along with it; its answer
+        // is discarded above instead, and its timeout still bounds the wait for it.
+        if (attempts->in_flight.size() > 1)
+            log(log::severity::trace) << "Leaving the other attempt to finish; its answer will be discarded.";
+        attempts->in_flight.clear();
+        if (attempts->hedge_timer)
+            attempts->hedge_timer->cancel();
+        serialize.unlock();
+    } else if (error and not attempts->answered_by) {
+        attempts->in_flight[attempt].reset();
+        bool other_attempt_pending = std::any_of(attempts->in_flight.begin(), attempts->in_flight.end(),
+                [] (const std::shared_ptr<request_with_timeout>& r) { return !! r; });
+        if (other_attempt_pending) {
+            log(log::severity::warning) << "Attempt " << attempt + 1 << " failed (" << error.message()
+                    << "); awaiting the other.";
+            return true;
+        }
+
+        // A transport which has been shut down reports these; there is no sense in trying it again.
+        // One which is overloaded would only be loaded further.
+        bool transport_halted = (error == std::errc::network_reset or error == std::errc::network_down);
+        bool transport_overloaded = (error == communication_failure::overloaded);
+        if (not transport_halted and not transport_overloaded and attempts->retries_made < attempts->retries_permitted) {
+            auto& failure_parameters = request_context_.request_failure_defaults;
+
+            // Exponential backoff, with equal jitter: wait at least half of the backoff, and a
+            // random part of the other half.
+            auto backoff = failure_parameters.retry_backoff.count() << std::min<std::size_t>(attempts->retries_made, 16);
+            std::uniform_int_distribution<decltype(backoff)> jitter(0, backoff - backoff / 2);
+            std::chrono::milliseconds delay(backoff / 2 + jitter(attempts->jitter));
+
+            bool within_deadline = (failure_parameters.request_deadline.count() == 0)
+                    or (std::chrono::steady_clock::now() + delay < attempts->started + failure_parameters.request_deadline);
+            if (within_deadline) {
+                ++attempts->retries_made;
+                log(log::severity::warning) << "Attempt " << attempt + 1 << " failed (" << error.message()
+                        << "); retrying in " << delay.count() << " ms.";
+
+                auto retry_timer = std::make_shared<boost::asio::deadline_timer>(client_.ios_);
+                retry_timer->expires_from_now(boost::posix_time::milliseconds(delay.count()));
+                retry_timer->async_wait(std::bind(&self::retry, shared_from_this(), attempts, retry_timer, _1));
+                return true;
+            } else {
+                log(log::severity::error) << "No time remains to retry the request.";
+            }
+        }
+
+        if (attempts->hedge_timer)
+            attempts->hedge_timer->cancel();
+        serialize.unlock();
+    } else {
+        serialize.unlock();
+    }
+
+    return attempts->handle_whole_response(error, bytes_received, data);
+}
+
+
+void client::request_runner::retry (
+        const std::shared_ptr<request_attempts>& attempts,
+        const shared_timer&,
+        const boost::system::error_code& error)
+{
+    if (not error) {
+        try {
+            send_attempt(attempts);
+        } catch (const std::system_error& e) {
+            log(log::severity::error) << "Retry could not be sent: " << e.what();
+            attempts->handle_whole_response(e.code(), 0, "");
+        }
+    } else {
+        attempts->handle_whole_response(std::make_error_code(std::errc::operation_canceled), 0, "");
+    }
+}
+
+
+void client::request_runner::hedge (
+        const std::shared_ptr<request_attempts>& attempts,
+        const shared_timer&,
+        const boost::system::error_code& error)
+{
+    boost::unique_lock<boost::mutex> serialize(attempts->mutex);
+    bool attempt_pending = std::any_of(attempts->in_flight.begin(), attempts->in_flight.end(),
+            [] (const std::shared_ptr<request_with_timeout>& r) { return !! r; });
+
+    // Hedge only the first attempt; a retry is already under way otherwise.
+    if (not error and not attempts->answered_by and attempt_pending and attempts->in_flight.size() == 1) {
+        serialize.unlock();
+        log(log::severity::trace) << "No response after " << attempts->hedge_delay->count()
+                << " ms; sending the request again.";
+        try {
+            send_attempt(attempts);
+        } catch (const std::system_error& e) {
+            log(log::severity::warning) << "Hedged attempt could not be sent: " << e.what();
+        }
+    }
 }
 
 
@@ -455,13 +1255,13 @@ bool client::request_runner::accept_put_response (
         put_response_handler respond_to_application,
         const std::error_code& error,
         std::size_t bytes_received,
-        const std::string& data)
+        const char* data)
 {
     if (not error) {
         log(log::severity::trace) << "Parsing server response ...";
 
         RpbPutResp response;
-        if (message::retrieve(response, data.size(), data)) {
+        if (message::retrieve(response, bytes_received, data)) {
             log(log::severity::info) << "PUT successful.";
             respond_to_application(riak::make_error_code());
         } else {
@@ -481,6 +1281,26 @@ bool client::request_runner::accept_put_response (
     namespace {
 //=============================================================================
 
+RpbGetReq basic_get_request_for (
+        const key& bucket,
+        const key& k,
+        bool head,
+        const application_request_context& context)
+{
+    RpbGetReq request;
+    request.set_bucket(bucket);
+    request.set_key(k);
+    auto& overridden = context.access_overrides;
+    if (overridden.r )            request.set_r           (*overridden.r);
+    if (overridden.pr)            request.set_pr          (*overridden.pr);
+    if (overridden.basic_quorum)  request.set_basic_quorum(*overridden.basic_quorum);
+    if (overridden.notfound_ok)   request.set_notfound_ok (*overridden.notfound_ok);
+    request.set_head(head);
+    request.set_deletedvclock(true);
+    return request;
+}
+
+
 RpbPutReq basic_put_request_for (
         const key& bucket,
         const key& k,
@@ -12,14 +12,18 @@
 #include <riak/log_null.hxx>
 #endif
 
+#include <boost/optional.hpp>
 #include <memory>
+#include <riak/latency_tracker.hxx>
 #include <riak/log.hxx>
 #include <riak/message.hxx>
 #include <riak/object_access_parameters.hxx>
+#include <riak/object_cache.hxx>
 #include <riak/request_failure_parameters.hxx>
 #include <riak/response_handlers.hxx>
 #include <riak/sibling_resolution.hxx>
 #include <riak/transport.hxx>
+#include <vector>
 
 namespace boost {
     namespace asio { class io_service; }
@@ -42,13 +46,29 @@ class client
      * \param dp will be used to deliver requests.
      * \param sr will be applied as a default to all cases of sibling resolution.
      * \param ios will be burdened with query transmission and reception events.
+     * \param cache, if given, holds the objects this client fetches, so that a GET of an object
+     *     which has not changed since need not transfer its value again.
      * \return a new Riak client which is ready to access the database endpoint targeted by dp.
      */
     client (const transport::delivery_provider&& dp,
             const sibling_resolution&& sr,
             boost::asio::io_service& ios,
             const request_failure_parameters& = failure_defaults,
-            const object_access_parameters& = access_override_defaults);
+            const object_access_parameters& = access_override_defaults,
+            const std::shared_ptr<object_cache>& cache = std::shared_ptr<object_cache>());
+
+    /*!
+     * As above, but with one delivery provider per priority class, as make_prioritized_transport
+     * produces them. Each call below takes a priority_class, which picks the provider through which
+     * all of its requests (including retries, hedges and sibling resolution) are delivered. A
+     * client made with a single provider has only class 0.
+     */
+    client (const std::vector<transport::delivery_provider>&& per_class,
+            const sibling_resolution&& sr,
+            boost::asio::io_service& ios,
+            const request_failure_parameters& = failure_defaults,
+            const object_access_parameters& = access_override_defaults,
+            const std::shared_ptr<object_cache>& cache = std::shared_ptr<object_cache>());
 
     /*! Defaults that allow total control to the database administrators. */
     static const object_access_parameters access_override_defaults;
@@ -59,16 +79,96 @@ class client
     /*! Yields the object access defaults with which this client was instantiated. */
     const object_access_parameters& object_access_override_defaults () const;
     
-    void get_object (const key& bucket, const key& k, get_response_handler);
-    void delete_object (const key& bucket, const key& k, delete_response_handler h);
+    void get_object (const key& bucket, const key& k, get_response_handler, std::size_t priority_class = 0);
+
+    /*!
+     * As get_object, but the server returns everything except the object's value. This suits
+     * checks for existence, or for metadata, of objects too large to fetch for the purpose. The
+     * vector clock returned may be given to put_object to replace the object.
+     */
+    void head_object (const key& bucket, const key& k, head_response_handler, std::size_t priority_class = 0);
+
+    /*!
+     * Fetches many objects of one bucket, as get_object would, under a single request context.
+     * \param each is called once per key, in whichever order the responses arrive.
+     * \param done is called once after all keys have been answered, or at once if keys is empty.
+     * \param concurrency bounds the number of GETs in flight at any moment.
+     */
+    void get_objects (
+            const key& bucket,
+            const std::vector<key>& keys,
+            keyed_get_response_handler each,
+            batch_completion_handler done,
+            std::size_t concurrency = 32,
+            std::size_t priority_class = 0);
+
+    /*!
+     * Stores value under the given key without first fetching it. Without a vector clock, this
+     * creates a sibling of any value already stored there (unless the bucket allows last write
+     * wins); with the vector clock of the value it replaces, it does not.
+     */
+    void put_object (
+            const key& bucket,
+            const key& k,
+            const std::shared_ptr<object>& value,
+            const boost::optional<vector_clock>&,
+            put_response_handler,
+            std::size_t priority_class = 0);
+
+    /*!
+     * As above, but the server returns the object as stored, which is handed over as by
+     * get_object. Its value_updater carries the new vector clock, so that the key may be written
+     * again without another GET. Siblings returned with put_returns::body are resolved.
+     */
+    void put_object (
+            const key& bucket,
+            const key& k,
+            const std::shared_ptr<object>& value,
+            const boost::optional<vector_clock>&,
+            put_returns,
+            get_response_handler,
+            std::size_t priority_class = 0);
+
+    /*!
+     * Stores many values of one bucket without a vector clock, as put_object would, under a
+     * single request context.
+     * \param each is called once per key, in whichever order the responses arrive.
+     * \param done is called once after all keys have been answered, or at once if values is empty.
+     * \param concurrency bounds the number of PUTs in flight at any moment.
+     */
+    void put_objects (
+            const key& bucket,
+            const std::vector<std::pair<key, std::shared_ptr<object>>>& values,
+            keyed_put_response_handler each,
+            batch_completion_handler done,
+            std::size_t concurrency = 32,
+            std::size_t priority_class = 0);
+    void delete_object (const key& bucket, const key& k, delete_response_handler h, std::size_t priority_class = 0);
+
+    /*!
+     * Lists every key of a bucket. Riak must traverse all keys in the cluster to do so; this is
+     * not meant for use in production traffic.
+     * \param on_keys is called with each batch of keys as it arrives, so that the whole listing
+     *     is never held in memory at once.
+     * \param on_done is called once after the last batch, or upon any failure.
+     */
+    void list_keys (const key& bucket, key_batch_handler on_keys, key_listing_completion_handler on_done,
+            std::size_t priority_class = 0);
 
   private:
-    transport::delivery_provider deliver_request_;
+    /*! Indexed by priority class. */
+    std::vector<transport::delivery_provider> deliver_request_;
     sibling_resolution resolve_siblings_;
     const object_access_parameters access_overrides_;
     const request_failure_parameters request_failure_defaults_;
     boost::asio::io_service& ios_;
 
+    /*! Response times of recent GETs, from which the delay before hedging a GET is derived. */
+    latency_tracker get_latencies_;
+
+    /*! May be null, in which case every GET transfers its object whole. */
+    std::shared_ptr<object_cache> cache_;
+
     /*! Logs all riak request-related activity (identified by riak::log::channel::core). */
 #   if RIAK_CPP_LOGGING_ENABLED
         boost::log::sources::severity_channel_logger_mt<log::severity, log::channel> log_;
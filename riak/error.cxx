@@ -23,6 +23,7 @@ class communication_failure_category
 		  case communication_failure::inappropriate_response_content: return "The Riak server sent a response that was parseable, but with invalid content.";
 		  case communication_failure::missing_vector_clock: return "Object found, but vector clock was missing -- this object may be poisoned and create siblings uncontrollably.";
 		  case communication_failure::response_timeout: return "The response took too long to arrive.";
+		  case communication_failure::overloaded: return "Too many requests were waiting for the Riak server; this one was not sent.";
 		  default: assert(false); return "Communication failure.";
 		}
 	}
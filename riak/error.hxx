@@ -19,6 +19,9 @@ enum class communication_failure {
 	missing_vector_clock,
 
 	response_timeout,
+
+	/*! The transport's queue of waiting requests was full, so the request was never sent. */
+	overloaded,
 };
 
 const std::error_category& communication_failure_category ();
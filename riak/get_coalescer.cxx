@@ -0,0 +1,91 @@
+#include <riak/get_coalescer.hxx>
+#include <cassert>
+#include <system_error>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+get_coalescer::get_coalescer (client& c)
+  : client_(c)
+{   }
+
+
+void get_coalescer::get_object (const key& bucket, const key& k, get_response_handler h)
+{
+    auto target = std::make_pair(bucket, k);
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& waiters = waiting_[target];
+    waiters.push_back(h);
+    bool first = (waiters.size() == 1);
+    serialize.unlock();
+
+    // The answer may arrive on another thread at once; it finds us among the waiters regardless.
+    if (first) {
+        try {
+            client_.get_object(bucket, k, std::bind(&get_coalescer::fan_out, this, target, _1, _2, _3));
+        } catch (const std::system_error& failure) {
+            withdraw(target, failure.code());
+            throw;
+        } catch (...) {
+            withdraw(target, std::make_error_code(std::errc::operation_canceled));
+            throw;
+        }
+    }
+}
+
+
+std::size_t get_coalescer::keys_in_flight () const
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    return waiting_.size();
+}
+
+
+void get_coalescer::fan_out (
+        const bucket_and_key& target,
+        const std::error_code& error,
+        std::shared_ptr<object>& value,
+        value_updater update)
+{
+    // Whoever asks from now on is answered by a fresh GET, as this answer may already be stale.
+    std::vector<get_response_handler> waiters;
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto entry = waiting_.find(target);
+    assert(entry != waiting_.end());
+    waiters.swap(entry->second);
+    waiting_.erase(entry);
+    serialize.unlock();
+
+    // Each waiter may alter its object, so none shares one with another.
+    for (std::size_t i = 1; i < waiters.size(); ++i) {
+        auto own_copy = value ? std::make_shared<object>(*value) : std::shared_ptr<object>();
+        waiters[i](error, own_copy, update);
+    }
+    waiters.front()(error, value, update);
+}
+
+
+void get_coalescer::withdraw (const bucket_and_key& target, const std::error_code& error)
+{
+    std::vector<get_response_handler> waiters;
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto entry = waiting_.find(target);
+    assert(entry != waiting_.end());
+    waiters.swap(entry->second);
+    waiting_.erase(entry);
+    serialize.unlock();
+
+    // The first waiter hears of the failure from its own call.
+    std::shared_ptr<object> no_content;
+    for (std::size_t i = 1; i < waiters.size(); ++i)
+        waiters[i](error, no_content, value_updater());
+}
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
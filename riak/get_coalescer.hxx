@@ -0,0 +1,54 @@
+#pragma once
+#include <boost/thread/mutex.hpp>
+#include <riak/client.hxx>
+#include <map>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+/*!
+ * Lets concurrent GETs of one key share a single request. While a GET for a key is outstanding,
+ * further GETs for it made through this coalescer wait for its answer rather than sending their
+ * own; siblings are thus resolved once for all of them. Every waiter is handed its own copy of the
+ * object, and a value updater bound to the vector clock returned.
+ *
+ * The client's object access parameters apply to every GET it makes, so requests coalesced here
+ * always agree on them. A coalescer does not outlive its client, and must itself survive until
+ * every GET made through it has been answered.
+ */
+class get_coalescer
+{
+  public:
+    explicit get_coalescer (client& c);
+
+    /*!
+     * As client::get_object, but joins any GET of the same key already in flight. Should the GET
+     * fail to be sent, the exception reaches the caller who sent it; anyone who joined it
+     * meanwhile is handed the error instead.
+     */
+    void get_object (const key& bucket, const key& k, get_response_handler);
+
+    /*! \return the number of keys for which a GET is in flight. */
+    std::size_t keys_in_flight () const;
+
+  private:
+    typedef std::pair<key, key> bucket_and_key;
+
+    client& client_;
+    mutable boost::mutex mutex_;
+
+    /*! Everyone waiting on each GET in flight, the one who sent it first. */
+    std::map<bucket_and_key, std::vector<get_response_handler>> waiting_;
+
+    void fan_out (const bucket_and_key&, const std::error_code&, std::shared_ptr<object>&, value_updater);
+
+    /*! Forgets a GET which was never sent. */
+    void withdraw (const bucket_and_key&, const std::error_code&);
+};
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
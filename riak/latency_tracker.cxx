@@ -0,0 +1,47 @@
+#include <riak/latency_tracker.hxx>
+#include <algorithm>
+#include <cassert>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+latency_tracker::latency_tracker (std::size_t window, std::size_t minimum_samples)
+  : minimum_samples_(std::min(std::max<std::size_t>(minimum_samples, 1), window))
+  , samples_(window)
+  , next_sample_(0)
+  , window_filled_(false)
+{
+    assert(window > 0);
+}
+
+
+void latency_tracker::record (std::chrono::milliseconds sample)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    samples_[next_sample_] = sample;
+    next_sample_ = (next_sample_ + 1) % samples_.size();
+    window_filled_ = window_filled_ or (next_sample_ == 0);
+}
+
+
+boost::optional<std::chrono::milliseconds> latency_tracker::percentile (double p) const
+{
+    assert(p >= 0 and p <= 100);
+    std::vector<std::chrono::milliseconds> recent;
+    {
+        boost::unique_lock<boost::mutex> serialize(mutex_);
+        std::size_t samples_taken = window_filled_ ? samples_.size() : next_sample_;
+        if (samples_taken < minimum_samples_)
+            return boost::none;
+        recent.assign(samples_.begin(), samples_.begin() + samples_taken);
+    }
+
+    auto rank = recent.begin() + static_cast<std::ptrdiff_t>((recent.size() - 1) * p / 100);
+    std::nth_element(recent.begin(), rank, recent.end());
+    return *rank;
+}
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,50 @@
+#pragma once
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cstddef>
+#include <vector>
+
+#ifdef _WIN32
+#include <boost/chrono.hpp>
+namespace std { namespace chrono = boost::chrono; }
+#else
+#include <chrono>
+#endif
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+/*!
+ * Remembers the most recent response times of one kind of request, so that the distribution of
+ * those times may be queried. Safe for concurrent use.
+ */
+class latency_tracker
+{
+  public:
+    /*!
+     * \param window is the number of most recent samples retained.
+     * \param minimum_samples is the number of samples needed before any percentile is reported.
+     */
+    explicit latency_tracker (std::size_t window = 256, std::size_t minimum_samples = 16);
+
+    void record (std::chrono::milliseconds);
+
+    /*!
+     * \param p must lie in [0, 100].
+     * \return the response time which p percent of recent responses took no longer than, or
+     *     nothing if too few responses have been seen to say.
+     */
+    boost::optional<std::chrono::milliseconds> percentile (double p) const;
+
+  private:
+    mutable boost::mutex mutex_;
+    const std::size_t minimum_samples_;
+    std::vector<std::chrono::milliseconds> samples_;
+    std::size_t next_sample_;
+    bool window_filled_;
+};
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
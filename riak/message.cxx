@@ -1,5 +1,6 @@
 #include <riak/message.hxx>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 #include <system_error>
 
 #ifdef _WIN32
@@ -19,58 +20,89 @@ namespace riak {
  *
  *     | Rest-of-Message Length (32 bits) | Message Code (8 bits) | Message Body |.
  *
- * \param begin must dereference to the first byte of an incoming sequence.
- * \param end must "point" to the byte immediately past the end of the received sequence.
- * \return An iterator which is equal to begin unless a complete response is available for
- *     consumption. In that case, it points to the character past the complete response.
+ * \param begin must point to the first byte of an incoming sequence.
+ * \param end must point to the byte immediately past the end of the received sequence.
+ * \return the length of the complete message at begin, or 0 if no complete message is available.
  */
-template <class iterator>
-static
-iterator next_partial_response (const iterator begin, const iterator end)
+std::size_t complete_message_length (const char* begin, const char* end)
 {
     assert(end >= begin);
-    bool request_length_available = ((end - begin) >= static_cast<int64_t>(sizeof(uint32_t)));
-    
-    if (request_length_available) {
-        uint32_t encoded_length = *reinterpret_cast<const uint32_t*>(&*begin);
-        uint32_t data_length = ntohl(encoded_length);
+    uint32_t encoded_length;
+    std::size_t bytes_available = end - begin;
 
-        bool complete_response_available = (end - begin - sizeof(encoded_length) >= data_length);
-        if (complete_response_available) {
-            iterator new_beginning = begin + sizeof(encoded_length) + data_length;
-            return new_beginning;
-        } else {
-            return begin;
-        }
+    if (bytes_available >= sizeof(encoded_length)) {
+        std::memcpy(&encoded_length, begin, sizeof(encoded_length));
+        std::size_t message_length = sizeof(encoded_length) + ntohl(encoded_length);
+        return (bytes_available >= message_length) ? message_length : 0;
     } else {
-        return begin;
+        return 0;
     }
 }
 
 
-bool handle_streaming_requests (
-        std::shared_ptr<std::vector<unsigned char>> buffer,
-        handler consume_complete_message,
-        const std::error_code& error,
-        std::size_t bytes_received,
-        const std::string& input)
+/*!
+ * Collects whole Riak messages from a stream of received bytes. Complete messages are handed
+ * out in place; only the incomplete message at the end of a read is retained, and consumed
+ * bytes are never erased from the front of a buffer one message at a time.
+ */
+class message_collector
+{
+  public:
+    explicit message_collector (handler h)
+      : consume_complete_message_(h)
+    {   }
+
+    bool accept (const std::error_code& error, std::size_t bytes_received, const char* input);
+
+  private:
+    bool deliver_complete_messages (const char*& begin, const char* end);
+
+    handler consume_complete_message_;
+    std::string partial_message_;
+};
+
+
+bool message_collector::accept (const std::error_code& error, std::size_t bytes_received, const char* input)
 {
     if (not error) {
-        buffer->insert(buffer->end(), input.begin(), input.end());
-        auto next_response = next_partial_response(buffer->begin(), buffer->end());
-        bool matched_whole_request = (next_response != buffer->begin());
-        
-        if (matched_whole_request) {
-            std::string one_request(buffer->begin(), next_response);
-            buffer->erase(buffer->begin(), next_response);
-            return consume_complete_message(error, one_request.size(), one_request);
+        bool request_satisfied;
+        if (partial_message_.empty()) {
+            // Messages contained wholly in this read need not be copied at all.
+            const char* unconsumed = input;
+            request_satisfied = deliver_complete_messages(unconsumed, input + bytes_received);
+            if (not request_satisfied)
+                partial_message_.assign(unconsumed, input + bytes_received);
         } else {
-            // Wait for more data!
-            return false;
+            partial_message_.append(input, bytes_received);
+            const char* begin = partial_message_.data();
+            const char* unconsumed = begin;
+            request_satisfied = deliver_complete_messages(unconsumed, begin + partial_message_.size());
+            if (not request_satisfied)
+                partial_message_.erase(0, unconsumed - begin);
         }
+
+        // Anything trailing the final response is of no interest.
+        if (request_satisfied)
+            partial_message_.clear();
+        return request_satisfied;
     } else {
-        return consume_complete_message(error, 0, "");
+        return consume_complete_message_(error, 0, "");
+    }
+}
+
+
+bool message_collector::deliver_complete_messages (const char*& begin, const char* end)
+{
+    std::size_t message_length;
+    while ((message_length = complete_message_length(begin, end)) != 0) {
+        const char* message = begin;
+        begin += message_length;
+        if (consume_complete_message_(std::error_code(), message_length, message))
+            return true;
     }
+
+    // Wait for more data!
+    return false;
 }
 
 //=============================================================================
@@ -81,8 +113,8 @@ buffering_handler make_buffering_handler (handler& h)
 {
     using namespace std::placeholders;
     
-    auto buffer = std::make_shared<std::vector<unsigned char>>();
-    return std::bind(&handle_streaming_requests, buffer, h, _1, _2, _3);
+    auto collector = std::make_shared<message_collector>(h);
+    return std::bind(&message_collector::accept, collector, _1, _2, _3);
 }
 
 //=============================================================================
@@ -92,26 +124,23 @@ buffering_handler make_buffering_handler (handler& h)
 template <typename PbMessageBody>
 wire_package package_with_code (code message_code, const PbMessageBody& b)
 {
-    using std::string;
-    string encoded_body;
-    b.SerializeToString(&encoded_body);
-    return wire_package(message_code, encoded_body);
+    // Sizing caches the sizes of all submessages, which the serialization below relies upon.
+    wire_package package(message_code, encoded_size(b));
+    b.SerializeWithCachedSizesToArray(reinterpret_cast<google::protobuf::uint8*>(package.body()));
+    return package;
 }
 
 
-bool extract_code_if_valid (code& c, std::size_t bytes_available, const std::string& input)
+bool extract_code_if_valid (code& c, std::size_t bytes_available, const char* input)
 {
     uint32_t encoded_length;
-    if (bytes_available >= sizeof(encoded_length)) {
-        std::istringstream input_data(input);
-        input_data.read(reinterpret_cast<char*>(&encoded_length), sizeof(encoded_length));
+    if (bytes_available > sizeof(encoded_length)) {
+        std::memcpy(&encoded_length, input, sizeof(encoded_length));
         uint32_t data_length = ntohl(encoded_length);
         bytes_available -= sizeof(encoded_length);
 
         if (data_length == bytes_available) {
-            uint8_t code_value;
-            input_data.read(reinterpret_cast<char*>(&code_value), sizeof(code_value));
-            c = code_value;
+            c = static_cast<uint8_t>(input[sizeof(encoded_length)]);
             return true;
         } else {
             return false;
@@ -127,14 +156,13 @@ bool retrieve_body_with_code (
         code expected_code,
         PbMessageBody& body,
         std::size_t bytes_available,
-        const std::string& input)
+        const char* input)
 {
     code received_code;
     bool format_valid = extract_code_if_valid(received_code, bytes_available, input);
     if (format_valid and received_code == expected_code) {
         size_t size_of_header = 5;  // 32-bit length, 8-bit code
-        std::string payload = input.substr(size_of_header);
-        return body.ParseFromString(payload);
+        return body.ParseFromArray(input + size_of_header, static_cast<int>(bytes_available - size_of_header));
     } else {
         return false;
     }
@@ -145,12 +173,16 @@ bool retrieve_body_with_code (
         }   // namespace (anonymous)
 //=============================================================================
 
+const code code::PingRequest(1);
+const code code::PingResponse(2);
 const code code::GetRequest(9);
 const code code::GetResponse(10);
 const code code::PutRequest(11);
 const code code::PutResponse(12);
 const code code::DeleteRequest(13);
 const code code::DeleteResponse(14);
+const code code::ListKeysRequest(17);
+const code code::ListKeysResponse(18);
 
 #define ENCODE(pbtype, codename)                 \
 template <>                                      \
@@ -161,41 +193,68 @@ wire_package encode (const pbtype& b) {          \
 ENCODE(RpbGetReq, GetRequest);
 ENCODE(RpbPutReq, PutRequest);
 ENCODE(RpbDelReq, DeleteRequest);
+ENCODE(RpbListKeysReq, ListKeysRequest);
 
 #undef ENCODE
 
 
-#define DECODE(pbtype, codename)                             \
-template <>                                                  \
-bool retrieve (pbtype& result, std::size_t n, const std::string& input) { \
-    return retrieve_body_with_code(code::codename, result, n, input);    \
+#define DECODE(pbtype, codename)                                      \
+template <>                                                           \
+bool retrieve (pbtype& result, std::size_t n, const char* input) {    \
+    return retrieve_body_with_code(code::codename, result, n, input); \
 }
 
 DECODE(RpbGetReq,  GetRequest );
 DECODE(RpbGetResp, GetResponse);
 DECODE(RpbPutReq,  PutRequest );
 DECODE(RpbPutResp, PutResponse);
+DECODE(RpbListKeysReq,  ListKeysRequest );
+DECODE(RpbListKeysResp, ListKeysResponse);
 
 #undef ENCODE
 
 
-bool verify_code(const code& expected_code, std::size_t bytes_received, const std::string& input) {
+bool verify_code(const code& expected_code, std::size_t bytes_received, const char* input) {
     code received_code;
     bool extraction_successful = extract_code_if_valid(received_code, bytes_received, input);
     return extraction_successful and (received_code == expected_code);
 }
 
 
-std::string wire_package::to_string () const
+wire_package::wire_package (code c, std::size_t body_size)
+  : message_code_(c)
 {
-    uint32_t message_length = sizeof(static_cast<uint8_t>(message_code_)) + body_.size();
+    uint32_t message_length = sizeof(static_cast<uint8_t>(message_code_)) + body_size;
     uint32_t encoded_length = htonl(message_length);
-    
-    std::string full_message;
-    full_message.append(reinterpret_cast<char*>(&encoded_length), sizeof(encoded_length));
-    full_message += message_code_;
-    full_message += body_;
-    return full_message;
+
+    data_.reserve(sizeof(encoded_length) + message_length);
+    data_.append(reinterpret_cast<char*>(&encoded_length), sizeof(encoded_length));
+    data_ += message_code_;
+    data_.resize(sizeof(encoded_length) + message_length);
+}
+
+
+wire_package::wire_package (code c, const std::string& message)
+  : message_code_(c)
+{
+    // Delegating constructors are unavailable to all of our compilers.
+    wire_package sized(c, message.size());
+    data_.swap(sized.data_);
+    std::copy(message.begin(), message.end(), body());
+}
+
+
+char* wire_package::body ()
+{
+    return &data_[sizeof(uint32_t) + sizeof(uint8_t)];
+}
+
+
+std::string wire_package::release ()
+{
+    std::string surrendered;
+    surrendered.swap(data_);
+    return surrendered;
 }
 
 //=============================================================================
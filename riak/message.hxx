@@ -16,18 +16,19 @@ namespace riak {
  * Such a handler should return according with whether the request has been completely
  * satisfied (i.e. no additional responses are expected). A return of true indicates
  * the end of the request, and should free transport resources. If such a handler is
- * invoked _without_ error, it may _assume_ that the given string constitutes a
+ * invoked _without_ error, it may _assume_ that the given bytes constitute a
  * complete Riak message of the form:
  *
  *     | Rest-of-Message Length (32 bits) | Message Code (8 bits) | Message Body |
  *
  * In this case, the given size will equal (rest_of_message_length + sizeof(uint32_t)).
+ * The bytes are owned by the caller, and remain valid only until the handler returns.
  *
  * Beware: The handler may not assume that the response's payload is sensible. The handler
  * is responsible for such validation as: is the response of the message type expected?
  * Is the body correctly encoded?
  */
-typedef std::function<bool(std::error_code, std::size_t, const std::string&)> handler;
+typedef std::function<bool(std::error_code, std::size_t, const char*)> handler;
 
 /*!
  * Exactly as handler, but prepared to accept any data input, including partial Riak messages.
@@ -39,20 +40,39 @@ typedef handler buffering_handler;
  * whole requests from that data.
  *
  * \param h will be called only when the returned handler has received a full Riak
- *     message as per the definition of handler. It will also be called in case an
- *     error is given from the caller.
+ *     message as per the definition of handler, once for each such message received, until
+ *     it returns true. It will also be called in case an error is given from the caller.
+ *     Messages are not copied unless they span several calls to the buffering handler.
  */
 buffering_handler make_buffering_handler (handler& h);
 
+/*!
+ * \return the number of bytes to which m encodes. As a side effect, the sizes of its submessages
+ *     are cached, as SerializeWithCachedSizes requires.
+ */
+template <typename PbMessage>
+std::size_t encoded_size (const PbMessage& m)
+{
+#if GOOGLE_PROTOBUF_VERSION >= 3001000
+    return m.ByteSizeLong();
+#else
+    return static_cast<std::size_t>(m.ByteSize());
+#endif
+}
+
 /*! Specifies the integer code used to identify a message. These values are copy/pasted from riakclient.proto. */
 struct code
 {
+    static const code PingRequest;
+    static const code PingResponse;
     static const code GetRequest;
     static const code GetResponse;
     static const code PutRequest;
     static const code PutResponse;
     static const code DeleteRequest;
     static const code DeleteResponse;
+    static const code ListKeysRequest;
+    static const code ListKeysResponse;
     
     operator std::uint8_t () const { assert(valid_); return value_; }
     
@@ -76,23 +96,36 @@ private:
     bool valid_;
 };
 
-/*! Represents a valid Riak message packaged and correctly formatted for over-the-wire transmission. */
+/*!
+ * Represents a valid Riak message packaged and correctly formatted for over-the-wire transmission.
+ * The header and body are held contiguously, exactly as they will be sent.
+ */
 class wire_package
 {
 public:
-    wire_package (code c, const std::string& message)
-      : message_code_(c),
-        body_(message)
-    {   }
+    /*! Packages a copy of the given, already encoded message body. */
+    wire_package (code c, const std::string& message);
+
+    /*!
+     * Prepares a package with room for a body of the given size, to be encoded in place via body().
+     * The body is zero-filled until then.
+     */
+    wire_package (code c, std::size_t body_size);
 
     std::uint8_t message_code () const { return message_code_; }
 
-    /*! Produces the over-the-wire transmittable message message. */
-    std::string to_string () const;
+    /*! \return the first byte of the message body, following the header. */
+    char* body ();
+
+    /*! Produces the over-the-wire transmittable message. */
+    const std::string& to_string () const { return data_; }
+
+    /*! Surrenders the over-the-wire transmittable message without copying it. *this is left empty. */
+    std::string release ();
 
 private:
     const code message_code_;
-    const std::string body_;
+    std::string data_;
 };
 
 /*!
@@ -106,6 +139,7 @@ wire_package encode (const PbMessageBody& b);
 template <> wire_package encode (const RpbGetReq&);
 template <> wire_package encode (const RpbPutReq&);
 template <> wire_package encode (const RpbDelReq&);
+template <> wire_package encode (const RpbListKeysReq&);
 
 /*!
  * Accepts a buffer and produces from it a Protocol Buffer structure which is verified to have arrived
@@ -113,14 +147,25 @@ template <> wire_package encode (const RpbDelReq&);
  * \return true iff decoding of the given protocol buffer was successful.
  */
 template <typename PbMessageBody>
-bool retrieve (PbMessageBody& body, std::size_t bytes_received, const std::string& data);
+bool retrieve (PbMessageBody& body, std::size_t bytes_received, const char* data);
 
-template <> bool retrieve (const RpbGetReq&,  std::size_t, const std::string&);
-template <> bool retrieve (const RpbGetResp&, std::size_t, const std::string&);
-template <> bool retrieve (const RpbPutReq&,  std::size_t, const std::string&);
-template <> bool retrieve (const RpbPutResp&, std::size_t, const std::string&);
+template <> bool retrieve (RpbGetReq&,  std::size_t, const char*);
+template <> bool retrieve (RpbGetResp&, std::size_t, const char*);
+template <> bool retrieve (RpbPutReq&,  std::size_t, const char*);
+template <> bool retrieve (RpbPutResp&, std::size_t, const char*);
+template <> bool retrieve (RpbListKeysReq&,  std::size_t, const char*);
+template <> bool retrieve (RpbListKeysResp&, std::size_t, const char*);
+
+/*!
+ * As above, for a message held in a string.
+ */
+template <typename PbMessageBody>
+bool retrieve (PbMessageBody& body, std::size_t bytes_received, const std::string& data)
+{
+    return retrieve(body, bytes_received, data.data());
+}
 
-bool verify_code (const code& c, std::size_t, const std::string&);
+bool verify_code (const code& c, std::size_t, const char*);
     
 //=============================================================================
     }   // namespace message
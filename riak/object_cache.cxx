@@ -0,0 +1,112 @@
+#include <riak/message.hxx>
+#include <riak/object_cache.hxx>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+object_cache::object_cache (std::size_t capacity)
+  : capacity_(capacity)
+  , bytes_held_(0)
+  , hits_(0)
+  , misses_(0)
+  , bytes_saved_(0)
+{   }
+
+
+boost::optional<vector_clock> object_cache::lookup (const key& bucket, const key& k)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto held = index_.find(std::make_pair(bucket, k));
+    if (held == index_.end()) {
+        ++misses_;
+        return boost::none;
+    }
+
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, held->second);
+    return held->second->vclock;
+}
+
+
+std::shared_ptr<object> object_cache::revalidate (const key& bucket, const key& k, const vector_clock& vclock)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto held = index_.find(std::make_pair(bucket, k));
+    if (held == index_.end() or held->second->vclock != vclock)
+        return std::shared_ptr<object>();
+
+    // The application may alter what it is handed; what is held must not change with it.
+    auto& value = *held->second->value;
+    bytes_saved_ += value.value().size();
+    return std::make_shared<object>(value);
+}
+
+
+void object_cache::store (const key& bucket, const key& k, const object& value, const vector_clock& vclock)
+{
+    auto target = std::make_pair(bucket, k);
+    std::size_t size = message::encoded_size(value) + bucket.size() + k.size() + vclock.size();
+    auto copy = std::make_shared<const object>(value);
+
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto held = index_.find(target);
+    if (held != index_.end())
+        erase(held);
+    if (size > capacity_)
+        return;
+
+    while (bytes_held_ + size > capacity_)
+        erase(index_.find(entries_.back().target));
+
+    entry e = { target, copy, vclock, size };
+    entries_.push_front(e);
+    index_[target] = entries_.begin();
+    bytes_held_ += size;
+}
+
+
+void object_cache::forget (const key& bucket, const key& k)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto held = index_.find(std::make_pair(bucket, k));
+    if (held != index_.end())
+        erase(held);
+}
+
+
+std::size_t object_cache::bytes_held () const
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    return bytes_held_;
+}
+
+
+std::uint64_t object_cache::hits () const
+{
+    return hits_;
+}
+
+
+std::uint64_t object_cache::misses () const
+{
+    return misses_;
+}
+
+
+std::uint64_t object_cache::bytes_saved () const
+{
+    return bytes_saved_;
+}
+
+
+void object_cache::erase (std::map<bucket_and_key, recency_list::iterator>::iterator held)
+{
+    bytes_held_ -= held->second->size;
+    entries_.erase(held->second);
+    index_.erase(held);
+}
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
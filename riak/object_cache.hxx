@@ -0,0 +1,90 @@
+#pragma once
+#include <boost/optional.hpp>
+#include <boost/thread/mutex.hpp>
+#include <riak/core_types.hxx>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+/*!
+ * Holds the objects last fetched by a client, each with its vector clock, up to a bound on their
+ * total size. Once full, the least recently used objects are evicted first.
+ *
+ * A client given a cache still asks Riak for every object, but a GET of a key held here carries
+ * its vector clock; if the object has not changed since, Riak answers without its value, and the
+ * held value is handed over instead. The cache may be shared by several clients and threads.
+ */
+class object_cache
+{
+  public:
+    /*!
+     * \param capacity bounds the bytes held, counting each object's encoded size, its key and its
+     *     vector clock. Larger objects are never held.
+     */
+    explicit object_cache (std::size_t capacity);
+
+    /*!
+     * Counts a hit or a miss, and marks any object held under the key as most recently used.
+     * \return the vector clock of the object held under the key, if any.
+     */
+    boost::optional<vector_clock> lookup (const key& bucket, const key& k);
+
+    /*!
+     * Called once Riak has confirmed the object under the key unchanged since the given vector
+     * clock. Counts the size of its value as saved.
+     * \return a copy of the object held, or null if it has been evicted or replaced meanwhile.
+     */
+    std::shared_ptr<object> revalidate (const key& bucket, const key& k, const vector_clock&);
+
+    /*! Holds a copy of the given object, replacing anything held under the key. */
+    void store (const key& bucket, const key& k, const object&, const vector_clock&);
+
+    void forget (const key& bucket, const key& k);
+
+    std::size_t bytes_held () const;
+
+    /*! GETs for keys held, and not held, at the time they were sent. */
+    std::uint64_t hits () const;
+    std::uint64_t misses () const;
+
+    /*! Bytes of object values not transferred, because Riak found the object held unchanged. */
+    std::uint64_t bytes_saved () const;
+
+  private:
+    typedef std::pair<key, key> bucket_and_key;
+
+    struct entry
+    {
+        bucket_and_key target;
+        std::shared_ptr<const object> value;
+        vector_clock vclock;
+        std::size_t size;
+    };
+
+    /*! Most recently used first. */
+    typedef std::list<entry> recency_list;
+
+    const std::size_t capacity_;
+    mutable boost::mutex mutex_;
+    recency_list entries_;
+    std::map<bucket_and_key, recency_list::iterator> index_;
+    std::size_t bytes_held_;
+
+    std::atomic<std::uint64_t> hits_;
+    std::atomic<std::uint64_t> misses_;
+    std::atomic<std::uint64_t> bytes_saved_;
+
+    /*! The caller holds mutex_. */
+    void erase (std::map<bucket_and_key, recency_list::iterator>::iterator);
+};
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
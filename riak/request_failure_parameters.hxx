@@ -28,6 +28,24 @@ struct request_failure_parameters
         outright. A value greater than zero will allow server-side entropy-reduction techniques
         to improve the long-term success rate of operations. */
     std::size_t retries_permitted;
+
+    /*! The delay before the first retry of a failed request. Each further retry waits about twice
+        as long as the one before, with a random part added so that requests which failed
+        together do not all retry together. Only requests which may safely be repeated (such as
+        GET and DELETE) are retried, and only upon failure of the network or server to respond. */
+    std::chrono::milliseconds retry_backoff;
+
+    /*! The total time a request may take across all of its attempts. No retry is begun if it
+        could not start before this budget runs out, and each attempt's response timeout is cut
+        to what remains of it. A value of zero imposes no limit. */
+    std::chrono::milliseconds request_deadline;
+
+    /*! If nonzero, a GET left unanswered for longer than this percentile (within [0, 100]) of
+        recent GET response times is sent a second time. Whichever response arrives first is used;
+        the other request runs its course, and its response is discarded, so that the connection
+        it travels on is kept. Each hedged request adds load to the cluster, so high percentiles
+        (95 or more) are advisable. Zero disables hedging. */
+    double hedge_percentile;
     
     /*!
      * \defgroup parameter_amendments
@@ -38,6 +56,9 @@ struct request_failure_parameters
     ///@{
     request_failure_parameters with_response_timeout (std::chrono::milliseconds t) const;
     request_failure_parameters with_retries_permitted (std::size_t n) const;
+    request_failure_parameters with_retry_backoff (std::chrono::milliseconds t) const;
+    request_failure_parameters with_request_deadline (std::chrono::milliseconds t) const;
+    request_failure_parameters with_hedge_percentile (double p) const;
     ///@}
 };
 
@@ -60,6 +81,33 @@ request_failure_parameters request_failure_parameters::with_retries_permitted (s
     return new_fp;
 }
 
+
+inline
+request_failure_parameters request_failure_parameters::with_retry_backoff (std::chrono::milliseconds new_value) const
+{
+    request_failure_parameters new_fp(*this);
+    new_fp.retry_backoff = new_value;
+    return new_fp;
+}
+
+
+inline
+request_failure_parameters request_failure_parameters::with_request_deadline (std::chrono::milliseconds new_value) const
+{
+    request_failure_parameters new_fp(*this);
+    new_fp.request_deadline = new_value;
+    return new_fp;
+}
+
+
+inline
+request_failure_parameters request_failure_parameters::with_hedge_percentile (double new_value) const
+{
+    request_failure_parameters new_fp(*this);
+    new_fp.hedge_percentile = new_value;
+    return new_fp;
+}
+
 //=============================================================================
 }   // namespace riak
 //=============================================================================
@@ -13,73 +13,157 @@ using std::placeholders::_3;
 
 
 request_with_timeout::request_with_timeout (
-		const std::string& data,
+		std::string data,
 		std::chrono::milliseconds timeout,
 		message::buffering_handler& h,
 		boost::asio::io_service& ios)
   : timeout_length_(timeout)
   , timeout_(ios)
   , response_callback_(h)
-  , request_data_(data)
-  , succeeded_(false)
-  , timed_out_(false)
+  , request_data_(std::move(data))
+  , delivering_(false)
+  , ended_(false)
+  , timeout_attempt_(0)
 {   }
 
 
 void request_with_timeout::dispatch_via (transport::delivery_provider& deliver)
 {
-	// The request can only be sent once.
-	assert(not terminate_request_ and not succeeded_ and not timed_out_);
+	// The request can only be sent once. The transport may answer before it returns, on this
+	// thread or another; such answers wait until the option to terminate the request is stored.
+	unique_lock<mutex> serialize(this->mutex_);
+	assert(not terminate_request_ and not delivering_ and not ended_);
+	delivering_ = true;
+	serialize.unlock();
+
 	auto on_response = std::bind(&request_with_timeout::on_response, shared_from_this(), _1, _2, _3);
-	terminate_request_ = deliver(request_data_, on_response);
+	auto terminate_request = deliver(std::move(request_data_), on_response);
 
-	timeout_.expires_from_now(boost::posix_time::milliseconds(timeout_length_.count()));
-	auto on_timeout = std::bind(&request_with_timeout::on_timeout, shared_from_this(), _1);
-	timeout_.async_wait(on_timeout);
+	serialize.lock();
+	terminate_request_ = terminate_request;
+	arm_timeout();
+	serialize.unlock();
+
+	handle_pending();
+}
+
+
+void request_with_timeout::on_response (std::error_code error, size_t bytes_received, const char* raw_data)
+{
+	unique_lock<mutex> serialize(this->mutex_);
+
+	// A request which was terminated, or has timed out, hears nothing further.
+	if (ended_)
+		return;
+
+	// The bytes are only ours until we return, so they are copied to be heard later.
+	if (delivering_) {
+		event parked = { error, bytes_received ? std::string(raw_data, bytes_received) : std::string(), false, 0 };
+		pending_.push_back(parked);
+		return;
+	}
+
+	delivering_ = true;
+	serialize.unlock();
+	handle(error, bytes_received, raw_data);
+	handle_pending();
 }
 
 
-void request_with_timeout::on_response (std::error_code error, size_t bytes_received, const std::string& raw_data)
+void request_with_timeout::on_timeout (const boost::system::error_code& error, std::size_t attempt)
 {
-	assert(not succeeded_ and (!! terminate_request_));
 	unique_lock<mutex> serialize(this->mutex_);
+	if (error or ended_ or attempt != timeout_attempt_)
+		return;
+
+	if (delivering_) {
+		event parked = { std::error_code(), std::string(), true, attempt };
+		pending_.push_back(parked);
+		return;
+	}
+
+	delivering_ = true;
+	serialize.unlock();
+	expire();
+	handle_pending();
+}
 
+
+void request_with_timeout::handle (std::error_code error, size_t bytes_received, const char* raw_data)
+{
 	// Whatever happened, it constitutes activity. Stop the timeout timer.
+	unique_lock<mutex> serialize(this->mutex_);
+	++timeout_attempt_;
 	timeout_.cancel();
+	serialize.unlock();
 
-	bool error_condition = (timed_out_ or error);
-	if (not error_condition) {
+	if (not error) {
 		if (response_callback_(std::error_code(), bytes_received, raw_data)) {
-			(*terminate_request_)(false);
-			succeeded_ = true;
-			terminate_request_.reset();
+			end(false);
 		} else {
-			timeout_.expires_from_now(boost::posix_time::milliseconds(timeout_length_.count()));
-			auto on_timeout = std::bind(&request_with_timeout::on_timeout, shared_from_this(), _1);
-			timeout_.async_wait(on_timeout);
+			serialize.lock();
+			arm_timeout();
 		}
 	} else {
-		(*terminate_request_)(true);
+		end(true);
+		response_callback_(error, 0, raw_data);
+	}
+}
 
-		// Timeout already satisfied the response callback.
-		if (not timed_out_)
-			response_callback_(error, 0, raw_data);
 
-		terminate_request_.reset();
-	}
+void request_with_timeout::expire ()
+{
+	auto timeout_error = make_error_code(communication_failure::response_timeout);
+	response_callback_(timeout_error, 0, "");
+
+	// The response may yet arrive; the connection cannot be reused before it does.
+	end(true);
+}
+
+
+void request_with_timeout::end (bool connection_is_dirty)
+{
+	unique_lock<mutex> serialize(this->mutex_);
+	ended_ = true;
+	++timeout_attempt_;
+	timeout_.cancel();
+	auto terminate_request = *terminate_request_;
+	terminate_request_.reset();
+	serialize.unlock();
+
+	terminate_request(connection_is_dirty);
+}
+
+
+void request_with_timeout::arm_timeout ()
+{
+	// Called under our lock.
+	timeout_.expires_from_now(boost::posix_time::milliseconds(timeout_length_.count()));
+	auto on_timeout = std::bind(&request_with_timeout::on_timeout, shared_from_this(), _1, timeout_attempt_);
+	timeout_.async_wait(on_timeout);
 }
 
 
-void request_with_timeout::on_timeout (const boost::system::error_code& error)
+void request_with_timeout::handle_pending ()
 {
-	assert(not timed_out_);
+	// Called by the thread which set delivering_, once done with what it came for.
 	unique_lock<mutex> serialize(this->mutex_);
-	timed_out_ = not error;
-	if (timed_out_) {
-		auto timeout_error = make_error_code(communication_failure::response_timeout);
-		response_callback_(timeout_error, 0, "");
-		terminate_request_.reset();
+	while (not ended_ and not pending_.empty()) {
+		auto next = pending_.front();
+		pending_.pop_front();
+		if (next.timed_out and next.attempt != timeout_attempt_)
+			continue;
+
+		serialize.unlock();
+		if (next.timed_out)
+			expire();
+		else
+			handle(next.error, next.data.size(), next.data.data());
+		serialize.lock();
 	}
+
+	pending_.clear();
+	delivering_ = false;
 }
 
 //=============================================================================
@@ -2,9 +2,11 @@
 #include <boost/asio/deadline_timer.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/optional.hpp>
+#include <deque>
 #include <memory>
 #include <riak/message.hxx>
 #include <riak/transport.hxx>
+#include <string>
 #include <system_error>
 
 #ifdef _WIN32
@@ -27,12 +29,13 @@ class request_with_timeout
 {
   public:
 	/*!
-	 * Packages a task, but does not send it or begin timeout calculations.
+	 * Packages a task, but does not send it or begin timeout calculations. The data is handed to
+	 * the transport upon dispatch, so it should be moved in where possible.
 	 * \param timeout is in milliseconds. It determines the maximum length of any radio silence
 	 *        from the server.
 	 */
 	request_with_timeout (
-			const std::string& data,
+			std::string data,
 			std::chrono::milliseconds timeout,
 			message::buffering_handler& h,
 			boost::asio::io_service& ios);
@@ -45,18 +48,42 @@ class request_with_timeout
 	void dispatch_via (transport::delivery_provider& p);
 
   private:
-	void on_response (std::error_code, std::size_t, const std::string&);
-	void on_timeout (const boost::system::error_code&);
-	  
+	/*! A response, or the expiry of the timeout, which arrived while another was being handled. */
+	struct event {
+		std::error_code error;
+		std::string data;
+		bool timed_out;
+		std::size_t attempt;
+	};
+
+	void on_response (std::error_code, std::size_t, const char*);
+	void on_timeout (const boost::system::error_code&, std::size_t attempt);
+	void handle (std::error_code, std::size_t, const char*);
+	void expire ();
+	void end (bool connection_is_dirty);
+	void arm_timeout ();
+	void handle_pending ();
+
+	/*! Guards the members below, but is never held while calling out of this object. */
 	mutable boost::mutex mutex_;
 	std::chrono::milliseconds timeout_length_;
 	boost::asio::deadline_timer timeout_;
 	message::buffering_handler response_callback_;
 	boost::optional<transport::option_to_terminate_request> terminate_request_;
-	const std::string request_data_;
-	
-	bool succeeded_;
-	bool timed_out_;
+	std::string request_data_;
+
+	/*! Set while one thread is dispatching the request or handling what arrived for it. Whatever
+	    arrives meanwhile waits in pending_ for that thread, so the response callback and the
+	    transport never hear from two threads at once. */
+	bool delivering_;
+	std::deque<event> pending_;
+
+	/*! Set once the request is terminated; nothing arriving later is heard. */
+	bool ended_;
+
+	/*! Identifies the current wait of timeout_, so that expiries already under way when it was
+	    cancelled can be ignored. */
+	std::size_t timeout_attempt_;
 };
 
 //=============================================================================
@@ -1,6 +1,9 @@
 #pragma once
+#include <boost/optional.hpp>
+#include <memory>
 #include <riak/core_types.hxx>
 #include <riak/error.hxx>
+#include <vector>
 
 //=============================================================================
 namespace riak {
@@ -9,6 +12,14 @@ namespace riak {
 typedef std::function<void(const std::error_code&)> delete_response_handler;
 typedef std::function<void(const std::error_code&)> put_response_handler;
 
+/*! What the server sends back for a successful PUT, besides its success. */
+enum class put_returns
+{
+    nothing,
+    head,       //!< the stored object's metadata and vector clock, without its value
+    body        //!< the stored object in full, including any siblings
+};
+
 /*!
  * Such a function promises to deliver the given value using correct update semantics. In terms of
  * a Riak store, this means remembering the bucket, key, and vector clock (most importantly) of a
@@ -17,6 +28,35 @@ typedef std::function<void(const std::error_code&)> put_response_handler;
 typedef std::function<void(const std::shared_ptr<object>&, put_response_handler)> value_updater;
 typedef std::function<void(const std::error_code&, std::shared_ptr<object>&, value_updater)> get_response_handler;
 
+/*!
+ * Everything a GET returns of an object but its value. Each sibling carries its content type, user
+ * metadata, indexes and so on, with an empty value; siblings are not resolved, since that would
+ * take their values. An object not found has no siblings, though a deleted one may still have a
+ * vector clock.
+ */
+struct object_head
+{
+    boost::optional<vector_clock> vclock;
+    std::vector<std::shared_ptr<object>> siblings;
+};
+
+typedef std::function<void(const std::error_code&, const object_head&)> head_response_handler;
+
+/*! As a get_response_handler, for one of several keys fetched together. */
+typedef std::function<void(const key&, const std::error_code&, std::shared_ptr<object>&, value_updater)> keyed_get_response_handler;
+
+/*! As a put_response_handler, for one of several keys stored together. */
+typedef std::function<void(const key&, const std::error_code&)> keyed_put_response_handler;
+
+/*! Called once every request of a batch has been answered. */
+typedef std::function<void()> batch_completion_handler;
+
+/*! Receives the keys of a bucket in the batches the server sends them in. */
+typedef std::function<void(const ::google::protobuf::RepeatedPtrField<key>&)> key_batch_handler;
+
+/*! Called once a listing of keys has ended, successfully or not. No batch follows. */
+typedef std::function<void(const std::error_code&)> key_listing_completion_handler;
+
 //=============================================================================
 }   // namespace riak
 //=============================================================================
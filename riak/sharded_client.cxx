@@ -0,0 +1,190 @@
+#include <riak/sharded_client.hxx>
+#include <cassert>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+sharded_client::sharded_client (
+        const transport_factory& make_transport,
+        const sibling_resolution& sr,
+        std::size_t shards,
+        const request_failure_parameters& fp,
+        const object_access_parameters& ao)
+  : next_turn_(0)
+{
+    assert(shards > 0);
+    for (std::size_t i = 0; i < shards; ++i) {
+        std::unique_ptr<shard> s(new shard);
+        s->keep_running.reset(new boost::asio::io_service::work(s->ios));
+        s->store.reset(new client(make_transport(s->ios), sibling_resolution(sr), s->ios, fp, ao));
+        shards_.push_back(std::move(s));
+    }
+
+    // Start only once every shard is whole, so that none runs while another is being built.
+    for (auto s = shards_.begin(); s != shards_.end(); ++s) {
+        auto& ios = (*s)->ios;
+        (*s)->thread = boost::thread([&ios] () { ios.run(); });
+    }
+}
+
+
+sharded_client::~sharded_client ()
+{
+    for (auto s = shards_.begin(); s != shards_.end(); ++s)
+        (*s)->ios.stop();
+    for (auto s = shards_.begin(); s != shards_.end(); ++s)
+        (*s)->thread.join();
+}
+
+
+std::size_t sharded_client::shard_count () const
+{
+    return shards_.size();
+}
+
+
+std::size_t sharded_client::shard_of (const key& bucket, const key& k) const
+{
+    // Keys of one bucket tend to share prefixes; the bucket's hash is mixed in as by boost::hash_combine.
+    std::size_t seed = std::hash<key>()(bucket);
+    seed ^= std::hash<key>()(k) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed % shards_.size();
+}
+
+
+void sharded_client::get_object (const key& bucket, const key& k, get_response_handler h)
+{
+    auto& s = *shards_[shard_of(bucket, k)];
+    client& store = *s.store;
+    s.ios.post([&store, bucket, k, h] () { store.get_object(bucket, k, h); });
+}
+
+
+void sharded_client::get_objects (
+        const key& bucket,
+        const std::vector<key>& keys,
+        keyed_get_response_handler each,
+        batch_completion_handler done,
+        std::size_t concurrency)
+{
+    std::vector<std::vector<key>> keys_by_shard(shards_.size());
+    for (auto k = keys.begin(); k != keys.end(); ++k)
+        keys_by_shard[shard_of(bucket, *k)].push_back(*k);
+
+    std::size_t shards_involved = 0;
+    for (auto part = keys_by_shard.begin(); part != keys_by_shard.end(); ++part)
+        shards_involved += part->empty() ? 0 : 1;
+    if (shards_involved == 0) {
+        done();
+        return;
+    }
+
+    auto shard_done = complete_after_all_shards(done, shards_involved);
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (keys_by_shard[i].empty())
+            continue;
+        client& store = *shards_[i]->store;
+        auto part = std::make_shared<std::vector<key>>(std::move(keys_by_shard[i]));
+        shards_[i]->ios.post([&store, bucket, part, each, shard_done, concurrency] () {
+            store.get_objects(bucket, *part, each, shard_done, concurrency);
+        });
+    }
+}
+
+
+void sharded_client::put_object (
+        const key& bucket,
+        const key& k,
+        const std::shared_ptr<object>& value,
+        const boost::optional<vector_clock>& vclock,
+        put_response_handler h)
+{
+    auto& s = *shards_[shard_of(bucket, k)];
+    client& store = *s.store;
+    s.ios.post([&store, bucket, k, value, vclock, h] () { store.put_object(bucket, k, value, vclock, h); });
+}
+
+
+void sharded_client::put_object (
+        const key& bucket,
+        const key& k,
+        const std::shared_ptr<object>& value,
+        const boost::optional<vector_clock>& vclock,
+        put_returns returns,
+        get_response_handler h)
+{
+    auto& s = *shards_[shard_of(bucket, k)];
+    client& store = *s.store;
+    s.ios.post([&store, bucket, k, value, vclock, returns, h] () { store.put_object(bucket, k, value, vclock, returns, h); });
+}
+
+
+void sharded_client::put_objects (
+        const key& bucket,
+        const std::vector<std::pair<key, std::shared_ptr<object>>>& values,
+        keyed_put_response_handler each,
+        batch_completion_handler done,
+        std::size_t concurrency)
+{
+    typedef std::vector<std::pair<key, std::shared_ptr<object>>> value_list;
+    std::vector<value_list> values_by_shard(shards_.size());
+    for (auto v = values.begin(); v != values.end(); ++v)
+        values_by_shard[shard_of(bucket, v->first)].push_back(*v);
+
+    std::size_t shards_involved = 0;
+    for (auto part = values_by_shard.begin(); part != values_by_shard.end(); ++part)
+        shards_involved += part->empty() ? 0 : 1;
+    if (shards_involved == 0) {
+        done();
+        return;
+    }
+
+    auto shard_done = complete_after_all_shards(done, shards_involved);
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (values_by_shard[i].empty())
+            continue;
+        client& store = *shards_[i]->store;
+        auto part = std::make_shared<value_list>(std::move(values_by_shard[i]));
+        shards_[i]->ios.post([&store, bucket, part, each, shard_done, concurrency] () {
+            store.put_objects(bucket, *part, each, shard_done, concurrency);
+        });
+    }
+}
+
+
+void sharded_client::delete_object (const key& bucket, const key& k, delete_response_handler h)
+{
+    auto& s = *shards_[shard_of(bucket, k)];
+    client& store = *s.store;
+    s.ios.post([&store, bucket, k, h] () { store.delete_object(bucket, k, h); });
+}
+
+
+void sharded_client::list_keys (const key& bucket, key_batch_handler on_keys, key_listing_completion_handler on_done)
+{
+    auto& s = next_shard();
+    client& store = *s.store;
+    s.ios.post([&store, bucket, on_keys, on_done] () { store.list_keys(bucket, on_keys, on_done); });
+}
+
+
+sharded_client::shard& sharded_client::next_shard ()
+{
+    return *shards_[next_turn_++ % shards_.size()];
+}
+
+
+batch_completion_handler sharded_client::complete_after_all_shards (batch_completion_handler done, std::size_t shards_involved)
+{
+    // Shards finish on their own threads; whichever finishes last reports for all.
+    auto shards_remaining = std::make_shared<std::atomic<std::size_t>>(shards_involved);
+    return [shards_remaining, done] () {
+        if (--*shards_remaining == 0)
+            done();
+    };
+}
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
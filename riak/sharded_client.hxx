@@ -0,0 +1,130 @@
+#pragma once
+#include <boost/asio/io_service.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/thread.hpp>
+#include <riak/client.hxx>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+//=============================================================================
+
+/*!
+ * Spreads work over several clients, each with an io_service, connections and a thread of its
+ * own. Such a shard shares nothing with the others: a request is handed to its shard's thread
+ * once, and is transmitted, timed and answered there alone. The locks taken along the way are
+ * therefore never contended by other shards.
+ *
+ * Requests naming a key go to the shard chosen by a hash of the bucket and key, so that requests
+ * for one key are always served in order by one shard. Others go to each shard in turn. Every
+ * handler is called on the thread of the shard which served its request, unless the request is
+ * failed by destruction of the sharded client.
+ */
+class sharded_client
+{
+  public:
+    /*! Produces the connections of one shard, whose events are to run on the given io_service. */
+    typedef std::function<transport::delivery_provider(boost::asio::io_service&)> transport_factory;
+
+    /*!
+     * \param make_transport is called once per shard, before any shard begins to run.
+     * \param sr will be applied as a default to all cases of sibling resolution.
+     * \param shards must be at least 1. Defaults to one per hardware thread.
+     * \post Every shard's thread is running.
+     */
+    sharded_client (
+            const transport_factory& make_transport,
+            const sibling_resolution& sr,
+            std::size_t shards = std::max(1u, boost::thread::hardware_concurrency()),
+            const request_failure_parameters& = client::failure_defaults,
+            const object_access_parameters& = client::access_override_defaults);
+
+    /*!
+     * Stops every shard's thread, then destroys the shards' clients and connections on the
+     * calling thread. Requests still waiting for or upon a connection fail with
+     * std::errc::network_reset, and their handlers are called on the calling thread, before this
+     * returns. Handlers which had yet to run on a shard's io_service, such as those of pending
+     * retries, are destroyed without being called.
+     */
+    ~sharded_client ();
+
+    std::size_t shard_count () const;
+
+    /*! \return the index of the shard serving requests for the given key. */
+    std::size_t shard_of (const key& bucket, const key& k) const;
+
+    /*! As client::get_object, on the key's shard. */
+    void get_object (const key& bucket, const key& k, get_response_handler);
+
+    /*!
+     * As client::get_objects. The keys are split among their shards, each of which fetches its
+     * own with the given concurrency.
+     * \param done is called once, after every shard has answered all of its keys.
+     */
+    void get_objects (
+            const key& bucket,
+            const std::vector<key>& keys,
+            keyed_get_response_handler each,
+            batch_completion_handler done,
+            std::size_t concurrency = 32);
+
+    /*! As client::put_object, on the key's shard. */
+    void put_object (
+            const key& bucket,
+            const key& k,
+            const std::shared_ptr<object>& value,
+            const boost::optional<vector_clock>&,
+            put_response_handler);
+
+    /*! As client::put_object, on the key's shard. */
+    void put_object (
+            const key& bucket,
+            const key& k,
+            const std::shared_ptr<object>& value,
+            const boost::optional<vector_clock>&,
+            put_returns,
+            get_response_handler);
+
+    /*! As get_objects, for client::put_objects. */
+    void put_objects (
+            const key& bucket,
+            const std::vector<std::pair<key, std::shared_ptr<object>>>& values,
+            keyed_put_response_handler each,
+            batch_completion_handler done,
+            std::size_t concurrency = 32);
+
+    /*! As client::delete_object, on the key's shard. */
+    void delete_object (const key& bucket, const key& k, delete_response_handler h);
+
+    /*! As client::list_keys, on the next shard in turn. */
+    void list_keys (const key& bucket, key_batch_handler on_keys, key_listing_completion_handler on_done);
+
+  private:
+    struct shard;
+
+    std::vector<std::unique_ptr<shard>> shards_;
+    std::atomic<std::size_t> next_turn_;
+
+    shard& next_shard ();
+    batch_completion_handler complete_after_all_shards (batch_completion_handler done, std::size_t shards_involved);
+};
+
+/*!
+ * One client, together with the io_service and thread which run it.
+ */
+struct sharded_client::shard
+{
+    boost::asio::io_service ios;
+    std::unique_ptr<boost::asio::io_service::work> keep_running;
+    std::unique_ptr<client> store;
+    boost::thread thread;
+};
+
+//=============================================================================
+}   // namespace riak
+//=============================================================================
@@ -24,16 +24,18 @@ typedef std::function<void(bool)> option_to_terminate_request;
 
 /*!
  * A callback used to deliver a response with an error code. The error code must evaluate
- * to false unless the transport encountered an error during receive.
+ * to false unless the transport encountered an error during receive. The given number of bytes
+ * received are owned by the transport, and remain valid only until the callback returns.
  */
-typedef std::function<void(std::error_code, std::size_t, const std::string&)> response_handler;
+typedef std::function<void(std::error_code, std::size_t, const char*)> response_handler;
 
 /*!
  * Dispatches the given request at the next available opportunity, holding the connection as long
  * as the returned termination option is not executed and does not fall out of scope. This function
  * should return immediately, constituting asynchronous behavior.
  *
- * \param request_data is an opaque binary blob to be transmitted to the server.
+ * \param request_data is an opaque binary blob to be transmitted to the server. It is taken by
+ *     value, so that a caller with no further use for it may move it along without copying.
  * \param on_result must always be called to indicate either failure or success, including upon
  *     destruction of the connection pool prior to resolution of a request. Multiple calls
  *     are permissible, and calls with empty payloads will affect timeouts. A conforming
@@ -41,7 +43,7 @@ typedef std::function<void(std::error_code, std::size_t, const std::string&)> re
  *     before the request can be satisfied.
  */
 typedef std::function<option_to_terminate_request(
-		const std::string& request_data,
+		std::string request_data,
 		response_handler on_result)> delivery_provider;
 
 //=============================================================================
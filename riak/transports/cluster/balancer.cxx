@@ -0,0 +1,302 @@
+#include <riak/message.hxx>
+#include <riak/transports/cluster/balancer.hxx>
+#include <cassert>
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+		namespace cluster {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+const double balancer::response_time_weight = 0.2;
+
+/*!
+ * Follows one request through the node it was sent to. The first response (or failure) yields a
+ * response time, and the first exercise of the termination option, or the destruction of this
+ * object without one, ends the request's claim upon its node. A request terminated dirty before
+ * any response was abandoned, as upon a timeout, and counts as a failure of its node.
+ */
+class balancer::routed_request
+{
+  public:
+    routed_request (const std::shared_ptr<balancer>& b, std::size_t node)
+      : balancer_(b)
+      , node_(node)
+      , sent_(std::chrono::steady_clock::now())
+      , answered_(false)
+      , terminated_(false)
+    {   }
+
+    ~routed_request () {
+        exercise(false);
+    }
+
+    void set_termination_option (transport::option_to_terminate_request terminate) {
+        boost::unique_lock<boost::mutex> serialize(mutex_);
+        terminate_ = terminate;
+    }
+
+    void receive (transport::response_handler h, std::error_code error, std::size_t n, const char* data) {
+        boost::unique_lock<boost::mutex> serialize(mutex_);
+        bool first_response = not answered_;
+        answered_ = true;
+        serialize.unlock();
+
+        if (first_response) {
+            auto response_time = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - sent_);
+            balancer_->on_first_response(node_, error ? std::max(response_time, balancer_->error_penalty_) : response_time, !! error);
+        }
+        h(error, n, data);
+    }
+
+    void exercise (bool connection_is_dirty) {
+        boost::unique_lock<boost::mutex> serialize(mutex_);
+        if (terminated_)
+            return;
+        terminated_ = true;
+        bool abandoned_unanswered = connection_is_dirty and not answered_;
+        transport::option_to_terminate_request terminate;
+        terminate.swap(terminate_);
+        serialize.unlock();
+
+        if (terminate)
+            terminate(connection_is_dirty);
+        balancer_->on_termination(node_, abandoned_unanswered);
+    }
+
+  private:
+    boost::mutex mutex_;
+    const std::shared_ptr<balancer> balancer_;
+    const std::size_t node_;
+    const std::chrono::steady_clock::time_point sent_;
+    transport::option_to_terminate_request terminate_;
+    bool answered_;
+    bool terminated_;
+};
+
+
+balancer::balancer (
+        std::vector<transport::delivery_provider> nodes,
+        boost::asio::io_service& ios,
+        std::chrono::milliseconds error_penalty,
+        const ejection_parameters& ejection)
+  : next_turn_(0)
+  , error_penalty_(std::chrono::duration_cast<std::chrono::microseconds>(error_penalty))
+  , ejection_(ejection)
+{
+    assert(not nodes.empty());
+    for (auto n = nodes.begin(); n != nodes.end(); ++n)
+        nodes_.push_back(node(*n, ios));
+}
+
+
+balancer::~balancer ()
+{
+    // Probes answer only to a live balancer; those in flight are simply abandoned.
+    for (auto n = nodes_.begin(); n != nodes_.end(); ++n) {
+        n->probe_timer->cancel();
+        if (n->probe)
+            n->probe(true);
+    }
+}
+
+
+transport::option_to_terminate_request balancer::deliver (
+        std::string r,
+        transport::response_handler h)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    std::size_t chosen = choose_node();
+    ++nodes_[chosen].outstanding;
+    transport::delivery_provider deliver_to_node = nodes_[chosen].deliver;
+    serialize.unlock();
+
+    // The node's transport holds the response handler, which must not keep the request alive;
+    // the request ends with its termination option, which only the caller holds.
+    auto request = std::make_shared<routed_request>(shared_from_this(), chosen);
+    std::weak_ptr<routed_request> weak_request = request;
+    auto observe_response = [weak_request, h] (std::error_code error, std::size_t n, const char* data) {
+        if (auto live_request = weak_request.lock())
+            live_request->receive(h, error, n, data);
+        else
+            h(error, n, data);
+    };
+    request->set_termination_option(deliver_to_node(std::move(r), observe_response));
+    return std::bind(&routed_request::exercise, request, _1);
+}
+
+
+std::size_t balancer::outstanding_requests (std::size_t node) const
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    return nodes_.at(node).outstanding;
+}
+
+
+bool balancer::is_ejected (std::size_t node) const
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    return nodes_.at(node).ejected;
+}
+
+
+std::size_t balancer::choose_node ()
+{
+    // Ejected nodes are passed over, unless none remain; a failing node is then better than none.
+    bool any_admitted = false;
+    for (auto n = nodes_.begin(); n != nodes_.end(); ++n)
+        any_admitted = any_admitted or not n->ejected;
+
+    // Start from whichever node's turn it is, so that ties are broken by rotation.
+    std::size_t best = next_turn_ % nodes_.size();
+    double best_cost = 0;
+    bool found = false;
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        std::size_t candidate = (next_turn_ + i) % nodes_.size();
+        const node& n = nodes_[candidate];
+        if (any_admitted and n.ejected)
+            continue;
+
+        // Adding one microsecond keeps the request count meaningful before any response time is known.
+        double cost = (n.outstanding + 1) * (n.mean_response_time + 1);
+        if (not found or cost < best_cost) {
+            best = candidate;
+            best_cost = cost;
+            found = true;
+        }
+    }
+
+    next_turn_ = best + 1;
+    return best;
+}
+
+
+void balancer::on_first_response (std::size_t node, std::chrono::microseconds response_time, bool failed)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& mean = nodes_[node].mean_response_time;
+    if (mean == 0)
+        mean = response_time.count();
+    else
+        mean += response_time_weight * (response_time.count() - mean);
+    count_outcome(node, failed);
+}
+
+
+void balancer::on_termination (std::size_t node, bool abandoned_unanswered)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    assert(nodes_[node].outstanding > 0);
+    --nodes_[node].outstanding;
+    if (abandoned_unanswered)
+        count_outcome(node, true);
+}
+
+
+void balancer::count_outcome (std::size_t node, bool failed)
+{
+    auto& n = nodes_[node];
+    if (not failed) {
+        n.consecutive_failures = 0;
+        return;
+    }
+
+    ++n.consecutive_failures;
+    if (ejection_.consecutive_failures > 0 and n.consecutive_failures >= ejection_.consecutive_failures and not n.ejected) {
+        n.ejected = true;
+        schedule_probe(node);
+    }
+}
+
+
+void balancer::schedule_probe (std::size_t node)
+{
+    // The timer must not keep the balancer alive; it would otherwise probe forever.
+    std::weak_ptr<balancer> self = shared_from_this();
+    auto& timer = *nodes_[node].probe_timer;
+    timer.expires_from_now(boost::posix_time::milliseconds(ejection_.probe_interval.count()));
+    timer.async_wait(std::bind(&balancer::on_probe_due, self, node, _1));
+}
+
+
+void balancer::on_probe_due (const std::weak_ptr<balancer>& self, std::size_t node, const boost::system::error_code& error)
+{
+    auto live_balancer = self.lock();
+    if (not error and live_balancer)
+        live_balancer->send_probe(node);
+}
+
+
+void balancer::send_probe (std::size_t node)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& n = nodes_[node];
+    if (not n.ejected)
+        return;
+
+    // A probe still unanswered after a whole interval is abandoned.
+    transport::option_to_terminate_request unanswered;
+    unanswered.swap(n.probe);
+    std::size_t probe = ++n.probes_sent;
+    transport::delivery_provider deliver_to_node = n.deliver;
+    schedule_probe(node);
+    serialize.unlock();
+    if (unanswered)
+        unanswered(true);
+
+    std::weak_ptr<balancer> self = shared_from_this();
+    auto on_response = [self, node, probe] (std::error_code error, std::size_t size, const char* data) {
+        if (auto live_balancer = self.lock())
+            live_balancer->on_probe_response(node, probe, error, size, data);
+    };
+    auto terminate = deliver_to_node(message::wire_package(message::code::PingRequest, std::string()).release(), on_response);
+
+    // The node may have answered already, ending the probe.
+    serialize.lock();
+    bool probe_in_flight = (n.probes_sent == probe);
+    bool still_ejected = n.ejected;
+    if (probe_in_flight)
+        n.probe.swap(terminate);
+    serialize.unlock();
+    if (not probe_in_flight)
+        terminate(still_ejected);
+}
+
+
+void balancer::on_probe_response (
+        std::size_t node,
+        std::size_t probe,
+        std::error_code error,
+        std::size_t size,
+        const char* data)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& n = nodes_[node];
+    if (n.probes_sent != probe)
+        return;
+
+    // Whatever else arrives for this probe is stale.
+    ++n.probes_sent;
+    transport::option_to_terminate_request finished;
+    finished.swap(n.probe);
+    bool answered = not error and message::verify_code(message::code::PingResponse, size, data);
+    if (answered) {
+        n.ejected = false;
+        n.consecutive_failures = 0;
+        n.probe_timer->cancel();
+    }
+    serialize.unlock();
+
+    if (finished)
+        finished(not answered);
+}
+
+//=============================================================================
+		}   // namespace cluster
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,128 @@
+#pragma once
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/mutex.hpp>
+#include <riak/transport.hxx>
+#include <riak/transports/cluster/ejection_parameters.hxx>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	include <boost/chrono.hpp>
+	namespace std { namespace chrono = boost::chrono; }
+#else
+#	include <chrono>
+#endif
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+		namespace cluster {
+//=============================================================================
+
+/*!
+ * Spreads requests among the transports of several Riak nodes. Each request goes to the node
+ * which is expected to answer it soonest: that with the least product of its requests outstanding
+ * (counting the new one) and its recent response time. Nodes which are equally good take turns.
+ *
+ * A node's response time is the time to the first response to each request, averaged with
+ * exponentially decaying weights. A request failing with an error counts as if it had taken
+ * error_penalty, so that a node refusing every request quickly does not draw all traffic to itself.
+ *
+ * A node failing several requests in a row is ejected: it receives no requests until it answers a
+ * ping, which is sent every probe_interval meanwhile. Should every node be ejected, requests are
+ * spread among all of them as if none were.
+ */
+class balancer
+      : public std::enable_shared_from_this<balancer>
+{
+  public:
+    /*!
+     * \param nodes must contain at least one transport. Each is used as is; the balancer adds
+     *     no connections of its own.
+     * \param ios will run the probes of ejected nodes. Must outlive the balancer.
+     * \param error_penalty is the response time attributed to a request which failed.
+     * \param ejection determines when a node is ejected, and how it is probed.
+     */
+    balancer (
+            std::vector<transport::delivery_provider> nodes,
+            boost::asio::io_service& ios,
+            std::chrono::milliseconds error_penalty = std::chrono::milliseconds(1000),
+            const ejection_parameters& ejection = ejection_parameters());
+
+    virtual ~balancer ();
+
+    virtual transport::option_to_terminate_request deliver (
+            std::string r,
+            transport::response_handler h);
+
+    /*! \return the number of requests which were delivered to the given node and not yet terminated. */
+    std::size_t outstanding_requests (std::size_t node) const;
+
+    /*! \return true iff the given node is ejected, receiving no requests until a probe succeeds. */
+    bool is_ejected (std::size_t node) const;
+
+  private:
+    struct node;
+    class routed_request;
+    friend class routed_request;
+
+    /*! The weight of each new response time in a node's average. */
+    static const double response_time_weight;
+
+    mutable boost::mutex mutex_;
+    std::vector<node> nodes_;
+    std::size_t next_turn_;
+    const std::chrono::microseconds error_penalty_;
+    const ejection_parameters ejection_;
+
+    std::size_t choose_node ();
+    void on_first_response (std::size_t node, std::chrono::microseconds response_time, bool failed);
+    void on_termination (std::size_t node, bool abandoned_unanswered);
+    void count_outcome (std::size_t node, bool failed);
+    void schedule_probe (std::size_t node);
+    static void on_probe_due (const std::weak_ptr<balancer>&, std::size_t node, const boost::system::error_code&);
+    void send_probe (std::size_t node);
+    void on_probe_response (std::size_t node, std::size_t probe, std::error_code, std::size_t, const char*);
+};
+
+/*!
+ * What the balancer knows of one node. Guarded by the balancer's mutex.
+ */
+struct balancer::node
+{
+    node (transport::delivery_provider d, boost::asio::io_service& ios)
+      : deliver(d)
+      , outstanding(0)
+      , mean_response_time(0)
+      , consecutive_failures(0)
+      , ejected(false)
+      , probes_sent(0)
+      , probe_timer(std::make_shared<boost::asio::deadline_timer>(ios))
+    {   }
+
+    transport::delivery_provider deliver;
+    std::size_t outstanding;
+
+    /*! In microseconds; zero until the first response. */
+    double mean_response_time;
+
+    std::size_t consecutive_failures;
+    bool ejected;
+
+    /*! Identifies the latest probe, so that answers to abandoned ones can be ignored. */
+    std::size_t probes_sent;
+
+    /*! Terminates the probe in flight, if any. */
+    transport::option_to_terminate_request probe;
+
+    /*! Shared only so that nodes may be held by value. */
+    std::shared_ptr<boost::asio::deadline_timer> probe_timer;
+};
+
+//=============================================================================
+		}   // namespace cluster
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
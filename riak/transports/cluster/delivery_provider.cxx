@@ -0,0 +1,32 @@
+#include "balancer.hxx"
+#include "delivery_provider.hxx"
+#include <riak/transports/single_serial_socket/delivery_provider.hxx>
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+
+transport::delivery_provider make_cluster_transport (
+        const std::vector<node_address>& nodes,
+        boost::asio::io_service& ios,
+        std::size_t connections_per_node,
+        const pool_parameters& parameters,
+        const ejection_parameters& ejection)
+{
+    assert(not nodes.empty());
+    std::vector<transport::delivery_provider> node_transports;
+    for (auto n = nodes.begin(); n != nodes.end(); ++n)
+        node_transports.push_back(make_pooled_transport(n->first, n->second, ios, connections_per_node, parameters));
+
+    auto transport = std::make_shared<cluster::balancer>(std::move(node_transports), ios, std::chrono::milliseconds(1000), ejection);
+    return std::bind(&cluster::balancer::deliver, transport, _1, _2);
+}
+
+//=============================================================================
+	}   // 	namespace transport
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,40 @@
+#pragma once
+#include <boost/asio/io_service.hpp>
+#include <riak/transport.hxx>
+#include <riak/transports/cluster/ejection_parameters.hxx>
+#include <riak/transports/single_serial_socket/pool_parameters.hxx>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+//=============================================================================
+
+/*! The host name (or address) and port of one Riak node. */
+typedef std::pair<std::string, uint16_t> node_address;
+
+/*!
+ * Produces a transport spreading requests among several nodes of one Riak cluster. Each node is
+ * served by a pool of connections_per_node sockets, as by make_pooled_transport. Every request is
+ * routed to the node with the fewest requests outstanding relative to its recent response time.
+ * A node failing several requests in a row receives none until it answers a ping.
+ *
+ * \param nodes must name at least one node.
+ * \param connections_per_node must be at least 1.
+ * \param parameters apply to the pool of every node.
+ * \param ejection determines when a failing node is ejected, and how often it is probed.
+ */
+transport::delivery_provider make_cluster_transport (
+        const std::vector<node_address>& nodes,
+        boost::asio::io_service& ios,
+        std::size_t connections_per_node = 1,
+        const pool_parameters& parameters = pool_parameters(),
+        const ejection_parameters& ejection = ejection_parameters());
+
+//=============================================================================
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
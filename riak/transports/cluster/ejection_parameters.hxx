@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+
+#ifdef _WIN32
+#	include <boost/chrono.hpp>
+	namespace std { namespace chrono = boost::chrono; }
+#else
+#	include <chrono>
+#endif
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+//=============================================================================
+
+/*!
+ * Determines when a cluster transport stops sending requests to a failing node, and how it finds
+ * out that the node has recovered.
+ */
+struct ejection_parameters
+{
+	ejection_parameters ()
+	  : consecutive_failures(5)
+	  , probe_interval(1000)
+	{   }
+
+	/*! The number of requests in a row which must fail for their node to be ejected. A request
+	    fails if it is answered with an error, or if it is abandoned (as upon a timeout) before
+	    any answer. Any successful response resets the count. Zero disables ejection. */
+	std::size_t consecutive_failures;
+
+	/*! While a node is ejected, it is pinged this often. The first successful ping readmits it;
+	    a ping unanswered by the next is abandoned. */
+	std::chrono::milliseconds probe_interval;
+
+	/*!
+	 * \defgroup parameter_amendments
+	 * These methods return a parameter set that is equivalent to *this with the exception of the
+	 * indicated value. Such calls may be chained to specify a group of parameters.
+	 */
+	///@{
+	ejection_parameters with_consecutive_failures (std::size_t n) const;
+	ejection_parameters with_probe_interval (std::chrono::milliseconds t) const;
+	///@}
+};
+
+//------------------------------- Here be inline definitions! ---------------------------------
+
+inline
+ejection_parameters ejection_parameters::with_consecutive_failures (std::size_t new_value) const
+{
+	ejection_parameters new_ep(*this);
+	new_ep.consecutive_failures = new_value;
+	return new_ep;
+}
+
+inline
+ejection_parameters ejection_parameters::with_probe_interval (std::chrono::milliseconds new_value) const
+{
+	ejection_parameters new_ep(*this);
+	new_ep.probe_interval = new_value;
+	return new_ep;
+}
+
+//=============================================================================
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
@@ -16,8 +16,8 @@ class asio_tcp_resolver
 	  : impl_(ios)
 	{   }
 
-	iterator resolve (const query& q) {
-		return impl_.resolve(q);
+	void async_resolve (const query& q, ResolveHandler handler) {
+		impl_.async_resolve(q, handler);
 	}
 
   private:
@@ -22,23 +22,26 @@ class asio_tcp_socket
   	}
 
   	virtual void close () {
-  		implementation_.close();
+  		boost::system::error_code ignored;
+  		implementation_.close(ignored);
   	}
 
+	// A socket is usually shut down because it has already failed; that may fail again harmlessly.
 	virtual void shutdown (asio::ip::tcp::socket::shutdown_type type) {
-		implementation_.shutdown(type);
+		boost::system::error_code ignored;
+		implementation_.shutdown(type, ignored);
 	}
 
-	virtual void async_read_some (boost::asio::streambuf& buffer, ReadHandler handler) {
-		implementation_.async_read_some(buffer.prepare(1024), handler);
+	virtual void async_read_some (const asio::mutable_buffer& buffer, ReadHandler handler) {
+		implementation_.async_read_some(asio::buffer(buffer), handler);
 	}
 
 	virtual void async_write_some (const asio::const_buffer& buffer, WriteHandler handler) {
 		implementation_.async_write_some(asio::buffer(buffer), handler);
 	}
 
-	virtual boost::system::error_code connect (const asio::ip::basic_resolver_entry<asio::ip::tcp>& endpoint, boost::system::error_code& error) {
-		return implementation_.connect(endpoint, error);
+	virtual void async_connect (const asio::ip::basic_resolver_entry<asio::ip::tcp>& endpoint, ConnectHandler handler) {
+		implementation_.async_connect(endpoint.endpoint(), handler);
 	}
 
   private:
@@ -0,0 +1,70 @@
+#include "caching_resolver.hxx"
+
+//=============================================================================
+namespace riak {
+    namespace transport {
+        namespace single_serial_socket {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+
+caching_resolver::caching_resolver (
+        std::shared_ptr<resolver> source,
+        boost::asio::io_service& ios,
+        std::chrono::milliseconds time_to_live)
+  : source_(std::move(source))
+  , ios_(ios)
+  , time_to_live_(time_to_live)
+{   }
+
+
+void caching_resolver::async_resolve (const query& q, ResolveHandler handler)
+{
+    const std::string name = q.host_name() + ":" + q.service_name();
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& cached = cache_[name];
+
+    // Even a stale result is worth trying while a fresh one is sought; hosts rarely move.
+    if (cached.resolved) {
+        std::function<void()> report = std::bind(handler, boost::system::error_code(), cached.endpoints);
+        ios_.post(report);
+    } else {
+        cached.waiting.push_back(handler);
+    }
+
+    bool fresh = cached.resolved and std::chrono::steady_clock::now() < cached.expires;
+    if (not fresh and not cached.refreshing) {
+        cached.refreshing = true;
+        serialize.unlock();
+        source_->async_resolve(q, std::bind(&caching_resolver::on_resolve, shared_from_this(), name, _1, _2));
+    }
+}
+
+
+void caching_resolver::on_resolve (
+        const std::string& name,
+        const boost::system::error_code& error,
+        iterator endpoints)
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    auto& cached = cache_[name];
+    cached.refreshing = false;
+    if (not error) {
+        cached.endpoints = endpoints;
+        cached.expires = std::chrono::steady_clock::now() + time_to_live_;
+        cached.resolved = true;
+    }
+
+    std::vector<ResolveHandler> waiting;
+    waiting.swap(cached.waiting);
+    serialize.unlock();
+    for (auto h = waiting.begin(); h != waiting.end(); ++h)
+        (*h)(error, endpoints);
+}
+
+//=============================================================================
+        }   // namespace single_serial_socket
+    }   // namespace transport
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,85 @@
+#pragma once
+#include "resolver.hxx"
+#include <boost/asio/io_service.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#	include <boost/chrono.hpp>
+	namespace std { namespace chrono = boost::chrono; }
+#else
+#	include <chrono>
+#endif
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+		namespace single_serial_socket {
+//=============================================================================
+
+/*!
+ * Remembers the addresses found by another resolver, so that reconnection need not wait on DNS.
+ * A remembered result is reported at once, even once its time to live has passed; in that case a
+ * fresh resolution is begun in the background, and its result is used by later callers. Should it
+ * fail, the stale addresses remain in use.
+ *
+ * Only the first resolution of a name waits on the source. Callers arriving meanwhile share its
+ * result, so a pool of sockets reconnecting together causes a single lookup.
+ *
+ * Must be owned by a std::shared_ptr, as resolutions in progress keep it alive.
+ */
+class caching_resolver
+	: public single_serial_socket::resolver
+	, public std::enable_shared_from_this<caching_resolver>
+{
+  public:
+	/*!
+	 * \param source performs the actual resolutions.
+	 * \param ios will be used to report remembered results. Must outlive this resolver.
+	 * \param time_to_live determines how long a result is used before it is refreshed.
+	 */
+	caching_resolver (
+			std::shared_ptr<resolver> source,
+			boost::asio::io_service& ios,
+			std::chrono::milliseconds time_to_live);
+
+	virtual void async_resolve (const query&, ResolveHandler);
+
+  private:
+	struct entry
+	{
+		entry ()
+		  : resolved(false)
+		  , refreshing(false)
+		{   }
+
+		/*! Valid only once resolved is set. */
+		iterator endpoints;
+		std::chrono::steady_clock::time_point expires;
+		bool resolved;
+
+		/*! Set while the source is resolving this name. */
+		bool refreshing;
+
+		/*! Callers awaiting the first resolution of this name. */
+		std::vector<ResolveHandler> waiting;
+	};
+
+	const std::shared_ptr<resolver> source_;
+	boost::asio::io_service& ios_;
+	const std::chrono::milliseconds time_to_live_;
+
+	boost::mutex mutex_;
+	std::map<std::string, entry> cache_;
+
+	void on_resolve (const std::string& name, const boost::system::error_code&, iterator);
+};
+
+//=============================================================================
+		}   // namespace single_serial_socket
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
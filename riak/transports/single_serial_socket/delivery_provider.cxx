@@ -1,11 +1,34 @@
 #include "asio_tcp_socket.hxx"
 #include "asio_tcp_resolver.hxx"
+#include "caching_resolver.hxx"
 #include "delivery_provider.hxx"
 #include "scheduler.hxx"
 
 //=============================================================================
 namespace riak {
 	namespace transport {
+		namespace {
+//=============================================================================
+
+std::shared_ptr<single_serial_socket::scheduler> make_pool (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters)
+{
+    assert(pool_size > 0);
+    std::vector<std::unique_ptr<single_serial_socket::socket>> sockets;
+    for (std::size_t i = 0; i < pool_size; ++i)
+        sockets.push_back(std::unique_ptr<single_serial_socket::socket>(new single_serial_socket::asio_tcp_socket(ios)));
+    std::shared_ptr<single_serial_socket::resolver> dns(new single_serial_socket::asio_tcp_resolver(ios));
+    auto resolver = std::make_shared<single_serial_socket::caching_resolver>(dns, ios, parameters.resolution_ttl);
+
+    return std::make_shared<single_serial_socket::scheduler>(address, port, ios, std::move(sockets), resolver, parameters);
+}
+
+//=============================================================================
+		}   // namespace (anonymous)
 //=============================================================================
 
 using std::placeholders::_1;
@@ -17,12 +40,66 @@ transport::delivery_provider make_single_socket_transport (
         boost::asio::io_service& ios)
 {
 	std::unique_ptr<single_serial_socket::socket> socket(new single_serial_socket::asio_tcp_socket(ios));
-	std::shared_ptr<single_serial_socket::resolver> resolver(new single_serial_socket::asio_tcp_resolver(ios));
+	std::shared_ptr<single_serial_socket::resolver> dns(new single_serial_socket::asio_tcp_resolver(ios));
+    auto resolver = std::make_shared<single_serial_socket::caching_resolver>(dns, ios, pool_parameters().resolution_ttl);
 
     auto transport = std::make_shared<single_serial_socket::scheduler>(address, port, ios, std::move(socket), resolver);
     return std::bind(&single_serial_socket::scheduler::deliver, transport, _1, _2);
 }
 
+
+transport::delivery_provider make_pooled_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters)
+{
+    auto transport = make_pool(address, port, ios, pool_size, parameters);
+    return std::bind(&single_serial_socket::scheduler::deliver, transport, _1, _2);
+}
+
+
+transport::delivery_provider make_pooled_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters,
+        queue_depth_gauge& depth)
+{
+    auto transport = make_pool(address, port, ios, pool_size, parameters);
+    std::weak_ptr<single_serial_socket::scheduler> observed(transport);
+    depth = [observed] () -> std::size_t {
+        auto live_transport = observed.lock();
+        return live_transport ? live_transport->queued_requests() : 0;
+    };
+    return std::bind(&single_serial_socket::scheduler::deliver, transport, _1, _2);
+}
+
+
+std::vector<transport::delivery_provider> make_prioritized_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters,
+        std::vector<queue_depth_gauge>& depths)
+{
+    auto transport = make_pool(address, port, ios, pool_size, parameters);
+    std::weak_ptr<single_serial_socket::scheduler> observed(transport);
+    std::vector<transport::delivery_provider> per_class;
+    depths.clear();
+    for (std::size_t k = 0; k < parameters.class_weights.size(); ++k) {
+        per_class.push_back(std::bind(&single_serial_socket::scheduler::deliver_as, transport, k, _1, _2));
+        depths.push_back([observed, k] () -> std::size_t {
+            auto live_transport = observed.lock();
+            return live_transport ? live_transport->queued_requests(k) : 0;
+        });
+    }
+    return per_class;
+}
+
 //=============================================================================
 	}   // 	namespace transport
 }   // namespace riak
@@ -1,7 +1,9 @@
 #pragma once
 #include <boost/asio/io_service.hpp>
 #include <string>
+#include <vector>
 #include <riak/transport.hxx>
+#include <riak/transports/single_serial_socket/pool_parameters.hxx>
 
 //=============================================================================
 namespace riak {
@@ -17,6 +19,57 @@ transport::delivery_provider make_single_socket_transport (
         uint16_t port,
         boost::asio::io_service& ios);
 
+/*!
+ * Produces a transport delivering requests along pool_size sockets to the same node. Unless
+ * pipelining is requested, each socket carries one request at a time; waiting requests are taken
+ * in order by the first free socket. A socket whose request terminates dirty is reconnected before
+ * it is used again. The node's addresses are looked up once for the whole pool, and remembered
+ * for parameters.resolution_ttl.
+ *
+ * \param pool_size must be at least 1.
+ * \param parameters may enable pipelining of requests on each socket.
+ */
+transport::delivery_provider make_pooled_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters = pool_parameters());
+
+/*!
+ * Reports the number of requests waiting in a pooled transport for a socket, or zero once the
+ * transport is gone.
+ */
+typedef std::function<std::size_t()> queue_depth_gauge;
+
+/*!
+ * As above, and also fills in depth with a gauge of the transport's queue. The gauge does not
+ * keep the transport alive.
+ */
+transport::delivery_provider make_pooled_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters,
+        queue_depth_gauge& depth);
+
+/*!
+ * Produces one delivery provider per priority class of parameters, all sharing one pool of
+ * pool_size sockets to the node. Requests delivered through the k-th provider wait in the k-th
+ * class; see pool_parameters::class_weights. A client given all of them picks the class of
+ * each request by the priority_class of the call that makes it.
+ *
+ * \param depths is filled with a gauge of each class's queue, in the same order.
+ */
+std::vector<transport::delivery_provider> make_prioritized_transport (
+        const std::string& address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::size_t pool_size,
+        const pool_parameters& parameters,
+        std::vector<queue_depth_gauge>& depths);
+
 //=============================================================================
 	}   // namespace transport
 }   // namespace riak
@@ -0,0 +1,251 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#ifdef _WIN32
+#	include <boost/chrono.hpp>
+	namespace std { namespace chrono = boost::chrono; }
+#else
+#	include <chrono>
+#endif
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+//=============================================================================
+
+/*!
+ * Determines what becomes of a request delivered to a pool whose queue is full.
+ */
+enum class overload_policy {
+	/*! The request fails at once with communication_failure::overloaded. */
+	reject,
+
+	/*! The delivering thread waits until the queue has room. Only a thread which is not running
+	    the pool's io_service may wait, as that is what makes room; a request delivered from one
+	    which is, as the client's retries and batches are, is rejected instead. */
+	block,
+
+	/*! The request is queued regardless, and the pool's overload handler is told. */
+	notify,
+};
+
+/*! Told the number of requests queued, including the one just delivered over the limit. */
+typedef std::function<void(std::size_t)> overload_handler;
+
+/*!
+ * Tunes the behavior of the connections held by a socket pool. None of these change what is sent
+ * to the Riak node; they determine only how requests share the connections to it.
+ */
+struct pool_parameters
+{
+	pool_parameters ()
+	  : pipeline_depth(1)
+	  , read_buffer_size(16 * 1024)
+	  , connect_timeout(5000)
+	  , reconnect_backoff(100)
+	  , max_reconnect_backoff(10000)
+	  , resolution_ttl(60000)
+	  , warm_up(false)
+	  , keepalive_interval(0)
+	  , max_queued_requests(0)
+	  , overload(overload_policy::reject)
+	  , max_queue_wait(0)
+	  , class_weights(1, 1)
+	  , drain_timeout(0)
+	{   }
+
+	/*! The number of requests which may be written on one connection before the first of them
+	    has been answered. Riak answers requests on a connection in order, so responses are
+	    matched to requests first-in, first-out. A value of 1 disables pipelining; in that case
+	    the transport does not interpret the bytes it receives. */
+	std::size_t pipeline_depth;
+
+	/*! The largest number of bytes taken from a socket in one read. Each connection reuses
+	    two buffers of this size, one receiving while the other is handed to the client. */
+	std::size_t read_buffer_size;
+
+	/*! The longest a connection attempt to any one address of the node may take, including
+	    resolution of the node's name. */
+	std::chrono::milliseconds connect_timeout;
+
+	/*! The wait before reconnecting a socket which failed to connect. Each further failure doubles
+	    the wait, up to max_reconnect_backoff; a random part of up to half is subtracted, so that
+	    sockets which failed together do not all retry together. Requests wait in the queue
+	    meanwhile. */
+	std::chrono::milliseconds reconnect_backoff;
+	std::chrono::milliseconds max_reconnect_backoff;
+
+	/*! How long the addresses found for the node are used before they are looked up again. The
+	    lookup is shared by all sockets of the pool, and reconnection never waits on it once the
+	    node has been resolved once. */
+	std::chrono::milliseconds resolution_ttl;
+
+	/*! If set, every socket pings the node as soon as it connects, and takes requests only once
+	    the node has answered. A socket whose ping goes unanswered for connect_timeout is
+	    reconnected. Every socket of the pool connects at startup, so all are thus warmed up
+	    before the first request reaches them. */
+	bool warm_up;
+
+	/*! A socket left idle this long pings the node, and is reconnected unless answered within
+	    connect_timeout. Half-open connections are thus found before a request is sent on them.
+	    Zero disables keepalive. */
+	std::chrono::milliseconds keepalive_interval;
+
+	/*! The most requests which may wait for a socket, counting from delivery until a socket takes
+	    them. Each waiting request holds its encoded payload, so this bounds the memory held while
+	    the node is slow. Zero leaves the queue unbounded. */
+	std::size_t max_queued_requests;
+
+	/*! What becomes of requests delivered while max_queued_requests are waiting. */
+	overload_policy overload;
+	overload_handler on_overload;
+
+	/*! The longest a request may wait for a socket. A request still waiting past this deadline
+	    is not sent; it fails with communication_failure::response_timeout when a socket would
+	    have taken it. Set it no longer than the client's response timeout, so that requests whose
+	    owners gave up are not sent after a burst of latency. Zero lets requests wait forever. */
+	std::chrono::milliseconds max_queue_wait;
+
+	/*! One weight per priority class of requests, each at least 1. Each class waits in a queue of
+	    its own; while several hold requests, sockets take from each in proportion to its weight.
+	    No class with requests waiting is starved, however light it is. Where the classes are
+	    due equally, the lower-numbered class goes first. A single class is served in order. */
+	std::vector<std::size_t> class_weights;
+
+	/*! If nonzero, a request abandoned in flight does not cost its socket a reconnection. The
+	    socket goes on to read the request's response, discards it, and is reused. Only if no
+	    response arrives within this time is the socket reconnected. Responses are then always
+	    split into frames, as if pipelining. Requests whose response may span several messages,
+	    such as key listings, still have their socket reconnected at once. */
+	std::chrono::milliseconds drain_timeout;
+
+	/*!
+	 * \defgroup parameter_amendments
+	 * These methods return a parameter set that is equivalent to *this with the exception of the
+	 * indicated value. Such calls may be chained to specify a group of parameters.
+	 */
+	///@{
+	pool_parameters with_pipeline_depth (std::size_t k) const;
+	pool_parameters with_read_buffer_size (std::size_t bytes) const;
+	pool_parameters with_connect_timeout (std::chrono::milliseconds t) const;
+	pool_parameters with_reconnect_backoff (std::chrono::milliseconds initial, std::chrono::milliseconds maximum) const;
+	pool_parameters with_resolution_ttl (std::chrono::milliseconds t) const;
+	pool_parameters with_warm_up (bool enabled) const;
+	pool_parameters with_keepalive_interval (std::chrono::milliseconds t) const;
+	pool_parameters with_queue_limit (std::size_t requests, overload_policy p) const;
+
+	/*! Also selects overload_policy::notify. */
+	pool_parameters with_overload_handler (overload_handler h) const;
+	pool_parameters with_max_queue_wait (std::chrono::milliseconds t) const;
+	pool_parameters with_priority_classes (const std::vector<std::size_t>& weights) const;
+	pool_parameters with_drain_timeout (std::chrono::milliseconds t) const;
+	///@}
+};
+
+//------------------------------- Here be inline definitions! ---------------------------------
+
+inline
+pool_parameters pool_parameters::with_pipeline_depth (std::size_t new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.pipeline_depth = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_read_buffer_size (std::size_t new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.read_buffer_size = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_connect_timeout (std::chrono::milliseconds new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.connect_timeout = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_reconnect_backoff (std::chrono::milliseconds initial, std::chrono::milliseconds maximum) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.reconnect_backoff = initial;
+	new_pp.max_reconnect_backoff = maximum;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_resolution_ttl (std::chrono::milliseconds new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.resolution_ttl = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_warm_up (bool new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.warm_up = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_keepalive_interval (std::chrono::milliseconds new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.keepalive_interval = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_queue_limit (std::size_t requests, overload_policy p) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.max_queued_requests = requests;
+	new_pp.overload = p;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_overload_handler (overload_handler h) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.overload = overload_policy::notify;
+	new_pp.on_overload = h;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_max_queue_wait (std::chrono::milliseconds new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.max_queue_wait = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_priority_classes (const std::vector<std::size_t>& new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.class_weights = new_value;
+	return new_pp;
+}
+
+inline
+pool_parameters pool_parameters::with_drain_timeout (std::chrono::milliseconds new_value) const
+{
+	pool_parameters new_pp(*this);
+	new_pp.drain_timeout = new_value;
+	return new_pp;
+}
+
+//=============================================================================
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
@@ -1,5 +1,6 @@
 #pragma once
 #include <boost/asio/ip/tcp.hpp>
+#include <functional>
 
 //=============================================================================
 namespace riak {
@@ -15,8 +16,9 @@ class resolver
 
 	typedef boost::asio::ip::tcp::resolver::iterator iterator;
 	typedef boost::asio::ip::tcp::resolver::query query;
+	typedef std::function<void(const boost::system::error_code&, iterator)> ResolveHandler;
 
-	virtual iterator resolve (const query&) = 0;
+	virtual void async_resolve (const query&, ResolveHandler) = 0;
 };
 
 //=============================================================================
@@ -1,11 +1,12 @@
 #include "socket.hxx"
 #include "resolver.hxx"
-#include <boost/asio/read.hpp>
-#include <boost/asio/write.hpp>
 #include <boost/lexical_cast.hpp>
+#include <riak/error.hxx>
 #include <riak/transport.hxx>
 #include <riak/transports/single_serial_socket/scheduler.hxx>
 #include <system_error>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <iostream>
 
@@ -15,68 +16,209 @@ namespace asio = boost::asio;
 namespace riak {
     namespace transport {
         namespace single_serial_socket {
+            namespace {
+//=============================================================================
+
+std::error_code to_std_error_code (const boost::system::error_code& error)
+{
+#if _MSC_VER >= 1600 && _MSC_VER < 1800
+    return std::make_error_code(static_cast<std::errc::errc>(error.value()));
+#else
+    return std::make_error_code(static_cast<std::errc>(error.value()));
+#endif
+}
+
+
+/*!
+ * \return true if Riak answers the given request with exactly one message, so that its response
+ *     can be recognized and skipped.
+ */
+bool answered_in_one_frame (const std::string& request)
+{
+    if (request.size() < 5)
+        return false;
+
+    auto request_code = static_cast<std::uint8_t>(request[4]);
+    return request_code == message::code::PingRequest
+        or request_code == message::code::GetRequest
+        or request_code == message::code::PutRequest
+        or request_code == message::code::DeleteRequest;
+}
+
+
+//=============================================================================
+            }   // namespace (anonymous)
 //=============================================================================
 
 using std::placeholders::_1;
 using std::placeholders::_2;
+using std::placeholders::_3;
+
+template <typename Handler>
+class scheduler::guarded_handler
+{
+  public:
+    guarded_handler (const std::shared_ptr<lifeline>& l, Handler h)
+      : lifeline_(l)
+      , handler_(h)
+    {   }
+
+    template <typename... Arguments>
+    void operator() (Arguments&&... arguments) {
+        if (lifeline_->enter()) {
+            struct departure {
+                ~departure () { l.leave(); }
+                lifeline& l;
+            } leave_when_done = { *lifeline_ };
+            handler_(std::forward<Arguments>(arguments)...);
+        }
+    }
+
+  private:
+    std::shared_ptr<lifeline> lifeline_;
+    Handler handler_;
+};
+
+
+template <typename Handler>
+scheduler::guarded_handler<Handler> scheduler::guard (Handler h) const
+{
+    return guarded_handler<Handler>(lifeline_, h);
+}
+
 
 scheduler::scheduler (
         const std::string& node_address,
         uint16_t port,
         boost::asio::io_service& ios,
         std::unique_ptr<socket> s,
-        const std::shared_ptr<resolver>& resolver)
+        const std::shared_ptr<resolver>& resolver,
+        const pool_parameters& parameters)
   : target_(node_address, boost::lexical_cast<std::string>(port))
   , ios_(ios)
-  , socket_(std::move(s))
+  , parameters_(parameters)
+  , lifeline_(std::make_shared<lifeline>())
   , resolver_(resolver)
+  , pending_requests_(parameters.class_weights.size())
+  , class_credit_(parameters.class_weights.size(), 0)
   , shutting_down_(false)
+  , queued_(0)
+  , queued_in_class_(new std::atomic<std::size_t>[parameters.class_weights.size()]())
+  , blocked_submitters_(0)
 {
-    connect_socket();
+    assert(parameters_.pipeline_depth > 0);
+    assert(not parameters_.class_weights.empty());
+    assert(std::find(parameters_.class_weights.begin(), parameters_.class_weights.end(), 0u) == parameters_.class_weights.end());
+    connections_.push_back(std::unique_ptr<connection>(new connection(std::move(s), ios)));
+    start_framing(*connections_.front());
+    connect_socket(*connections_.front());
+}
+
+
+scheduler::scheduler (
+        const std::string& node_address,
+        uint16_t port,
+        boost::asio::io_service& ios,
+        std::vector<std::unique_ptr<socket>> sockets,
+        const std::shared_ptr<resolver>& resolver,
+        const pool_parameters& parameters)
+  : target_(node_address, boost::lexical_cast<std::string>(port))
+  , ios_(ios)
+  , parameters_(parameters)
+  , lifeline_(std::make_shared<lifeline>())
+  , resolver_(resolver)
+  , pending_requests_(parameters.class_weights.size())
+  , class_credit_(parameters.class_weights.size(), 0)
+  , shutting_down_(false)
+  , queued_(0)
+  , queued_in_class_(new std::atomic<std::size_t>[parameters.class_weights.size()]())
+  , blocked_submitters_(0)
+{
+    assert(not sockets.empty());
+    assert(parameters_.pipeline_depth > 0);
+    assert(not parameters_.class_weights.empty());
+    assert(std::find(parameters_.class_weights.begin(), parameters_.class_weights.end(), 0u) == parameters_.class_weights.end());
+    for (auto s = sockets.begin(); s != sockets.end(); ++s) {
+        connections_.push_back(std::unique_ptr<connection>(new connection(std::move(*s), ios)));
+        start_framing(*connections_.back());
+        connect_socket(*connections_.back());
+    }
 }
 
 
 scheduler::~scheduler ()
 {
     boost::unique_lock<boost::mutex> serialize(mutex_);
-    
-    // Prevent new requests from entering, so we don't race over the pending_requests_ list.
+
+    // Prevent new requests from entering, so we don't race over the pending_requests_ queues.
     shutting_down_ = true;
-    
-    // Report the shutdown to all clients.
-    for (auto entry = pending_requests_.begin(); entry != pending_requests_.end(); ++entry) {
-        auto pending_request = *entry;
-        auto response_handler = pending_request->second;
-        response_handler(std::make_error_code(std::errc::network_reset), 0, "");
-    }
-    
-    while (not pending_requests_.empty())
-        request_dequeued_.wait(serialize);
-    
-    // Requests may have been made active while we were cleaning, so this has to be last!
-    socket_->cancel();
-    while (active_request_)
-        active_request_finished_.wait(serialize);
-    
+    room_in_queue_.notify_all();
+    while (blocked_submitters_ > 0)
+        submitters_left_.wait(serialize);
+    serialize.unlock();
+
+    // Handlers still held by ios or the sockets must find us gone; those running must finish
+    // first. After that, the connections are ours alone.
+    lifeline_->end();
+
+    std::vector<std::shared_ptr<enqueued_request>> outstanding;
+    serialize.lock();
+    for (auto q = pending_requests_.begin(); q != pending_requests_.end(); ++q)
+        outstanding.insert(outstanding.end(), q->begin(), q->end());
+    auto submitted = submissions_.take_all();
+    outstanding.insert(outstanding.end(), submitted.begin(), submitted.end());
+    serialize.unlock();
+    for (auto c = connections_.begin(); c != connections_.end(); ++c)
+        outstanding.insert(outstanding.end(), (*c)->in_flight.begin(), (*c)->in_flight.end());
+
+    // Report the shutdown to all clients. Their attempts to terminate their requests in response
+    // find us gone, and do nothing.
+    for (auto entry = outstanding.begin(); entry != outstanding.end(); ++entry)
+        if (not (*entry)->withdrawn)
+            (*entry)->on_response(std::make_error_code(std::errc::network_reset), 0, "");
+
     using boost::asio::ip::tcp;
-    socket_->shutdown(tcp::socket::shutdown_both);
-    socket_->close();
+    for (auto c = connections_.begin(); c != connections_.end(); ++c) {
+        (*c)->connect_timer.cancel();
+        (*c)->keepalive_timer.cancel();
+        (*c)->drain_timer.cancel();
+        auto& physical_socket = *(*c)->socket;
+        physical_socket.cancel();
+        physical_socket.shutdown(tcp::socket::shutdown_both);
+        physical_socket.close();
+    }
 }
 
 
 transport::option_to_terminate_request scheduler::deliver (
-        const std::string& r,
+        std::string r,
         transport::response_handler h)
 {
-    auto packed_request = std::make_shared<enqueued_request>(std::make_pair(r, h));
-    boost::unique_lock<boost::mutex> serialize(mutex_);
-    if (not shutting_down_) {
-        auto queue_position = pending_requests_.insert(pending_requests_.end(), packed_request);
-        if (not active_request_)
-            run_next_request();
-        
+    return deliver_as(0, std::move(r), h);
+}
+
+
+transport::option_to_terminate_request scheduler::deliver_as (
+        std::size_t priority_class,
+        std::string r,
+        transport::response_handler h)
+{
+    assert(priority_class < pending_requests_.size());
+    if (not shutting_down_ and not admit(priority_class)) {
+        // The handler hears of the rejection through ios, as it would of any other failure.
+        ios_.post(std::bind(h, make_error_code(communication_failure::overloaded), 0, ""));
+        return [] (bool) {   };
+    } else if (not shutting_down_) {
+        // Whoever finds the submission queue empty arranges for it to be taken; the rest need not.
+        auto packed_request = std::make_shared<enqueued_request>(std::move(r), h);
+        packed_request->priority_class = priority_class;
+        if (parameters_.max_queue_wait.count() > 0)
+            packed_request->deadline = std::chrono::steady_clock::now() + parameters_.max_queue_wait;
+        if (submissions_.push(packed_request))
+            ios_.post(guard(std::bind(&scheduler::take_submissions, this)));
+
         typedef scheduler::option_to_terminate_request option;
-        auto request_terminator = std::make_shared<option>(*this, packed_request, queue_position);
+        auto request_terminator = std::make_shared<option>(*this, packed_request);
         return std::bind(&option::exercise, request_terminator, _1);
     } else {
         throw std::system_error(std::make_error_code(std::errc::network_down),
@@ -85,152 +227,723 @@ transport::option_to_terminate_request scheduler::deliver (
 }
 
 
+std::size_t scheduler::queued_requests () const
+{
+    return queued_;
+}
+
+
+std::size_t scheduler::queued_requests (std::size_t priority_class) const
+{
+    assert(priority_class < pending_requests_.size());
+    return queued_in_class_[priority_class];
+}
+
+
+bool scheduler::admit (std::size_t priority_class)
+{
+    // The limit applies to all classes together; the weights decide only who leaves first.
+    auto limit = parameters_.max_queued_requests;
+    if (limit == 0) {
+        ++queued_;
+        ++queued_in_class_[priority_class];
+        return true;
+    }
+
+    switch (parameters_.overload) {
+      case overload_policy::block: {
+        boost::unique_lock<boost::mutex> serialize(mutex_);
+        if (queued_ >= limit and called_from_ios()) {
+            // Room is made only by handlers on ios, which this thread would no longer run.
+            return false;
+        }
+
+        ++blocked_submitters_;
+        while (queued_ >= limit and not shutting_down_)
+            room_in_queue_.wait(serialize);
+        --blocked_submitters_;
+
+        // The destructor waits for us to leave; nothing of ours may be touched once we have.
+        if (shutting_down_) {
+            submitters_left_.notify_all();
+            throw std::system_error(std::make_error_code(std::errc::network_down),
+                    "This single serial socket transport was halted while the request waited to be queued.");
+        }
+        ++queued_;
+        ++queued_in_class_[priority_class];
+        return true;
+      }
+
+      case overload_policy::notify: {
+        auto now_queued = ++queued_;
+        ++queued_in_class_[priority_class];
+        if (now_queued > limit and parameters_.on_overload)
+            parameters_.on_overload(now_queued);
+        return true;
+      }
+
+      case overload_policy::reject:
+      default:
+        if (++queued_ > limit) {
+            --queued_;
+            return false;
+        }
+        ++queued_in_class_[priority_class];
+        return true;
+    }
+}
+
+
+bool scheduler::called_from_ios () const
+{
+    // ios runs a dispatched handler at once only on a thread which is running it. Elsewhere, the
+    // handler is merely posted, and sets a flag no longer looked at.
+    auto called = std::make_shared<bool>(false);
+    ios_.dispatch([called] () { *called = true; });
+    return *called;
+}
+
+
+void scheduler::leave_queue (std::size_t priority_class)
+{
+    --queued_;
+    --queued_in_class_[priority_class];
+    if (parameters_.overload == overload_policy::block)
+        room_in_queue_.notify_one();
+}
+
+
 void scheduler::on_read (
-        std::shared_ptr<scheduler::enqueued_request> intended_recipient,
+        connection& c,
+        std::size_t generation,
         const boost::system::error_code& error,
         size_t n_read)
 {
-    boost::unique_lock<boost::mutex> serialize(mutex_);
-    
-    if (active_request_ == intended_recipient) {
-        if (not error) {
-            read_buffer_.commit(n_read);
-            std::istream byte_stream(&read_buffer_);
-            std::string received_bytes;
-            received_bytes.resize(n_read);
-            byte_stream.read(&received_bytes[0], n_read);
-            
-            // We schedule the new read in advance, because we want to be able to cancel a socket
-            // operation to trigger request closure.
-            auto this_ongoing_request = intended_recipient;
-            auto on_read = std::bind(&scheduler::on_read, this, this_ongoing_request, _1, _2);
-            socket_->async_read_some(read_buffer_, on_read);
-            
-            // The handler must be allowed to enqueue new requests recursively. Hence
-            // the lack of serialization here.
-            auto handler = active_request_->second;
-            serialize.unlock();
-#if _MSC_VER >= 1600 && _MSC_VER < 1800
-            auto error_code = std::make_error_code(static_cast<std::errc::errc>(error.value()));
-#else
-            auto error_code = std::make_error_code(static_cast<std::errc>(error.value()));
-#endif
-            handler(error_code, n_read, received_bytes);
-        } else {
-            handle_socket_error(error, std::move(serialize));
-        }
-    } else {
-        // No closing of the connection: we moved on to the next request.
+    // No closing of the connection: it was already replaced.
+    if (c.generation != generation)
+        return;
+
+    c.reading = false;
+    if (error or c.poisoned) {
+        handle_socket_error(c, error ? error : asio::error::operation_aborted);
+        return;
     }
+    c.last_activity = std::chrono::steady_clock::now();
+
+    // Take the filled buffer, and read ahead into the spare one. We schedule the new read in
+    // advance, because we want to be able to cancel a socket operation to trigger request closure.
+    std::vector<char> received;
+    received.swap(c.read_buffer);
+    c.read_buffer.swap(c.spare_buffer);
+    listen(c);
+    deliver_received(c, std::move(received), n_read);
 }
 
 
 void scheduler::on_write (
-        std::shared_ptr<scheduler::enqueued_request> intended_recipient,
+        connection& c,
+        std::size_t generation,
+        std::shared_ptr<enqueued_request> request,
+        std::size_t offset,
         const boost::system::error_code& error,
-        size_t)
+        size_t n_written)
 {
-    boost::unique_lock<boost::mutex> serialize(mutex_);
-    
-    if (intended_recipient == active_request_) {
-        if (not error) {
-            auto on_read = std::bind(&scheduler::on_read, this, active_request_, _1, _2);
-            socket_->async_read_some(read_buffer_, on_read);
+    if (c.generation != generation)
+        return;
+
+    if (error or c.poisoned) {
+        c.writing = false;
+        handle_socket_error(c, error ? error : asio::error::operation_aborted);
+    } else if (offset + n_written < request->data.size()) {
+        c.last_activity = std::chrono::steady_clock::now();
+        write_from(c, request, offset + n_written);
+    } else {
+        c.last_activity = std::chrono::steady_clock::now();
+        c.writing = false;
+        listen(c);
+        run_next_request(c);
+    }
+}
+
+
+void scheduler::write_from (connection& c, std::shared_ptr<enqueued_request> request, std::size_t offset)
+{
+    // The request is held until the write completes, as its data may be abandoned meanwhile.
+    auto on_write = c.strand.wrap(guard(std::bind(&scheduler::on_write, this, std::ref(c), c.generation, request, offset, _1, _2)));
+    asio::const_buffer rest(request->data.data() + offset, request->data.size() - offset);
+    auto& s = *c.socket;
+    issue(c, [&s, rest, on_write] () { s.async_write_some(rest, on_write); });
+}
+
+
+void scheduler::listen (connection& c)
+{
+    if (not c.reading and not c.in_flight.empty()) {
+        if (c.read_buffer.empty())
+            c.read_buffer.resize(parameters_.read_buffer_size);
+
+        // The buffer is not handed on before the read completes, so it may be named now.
+        c.reading = true;
+        auto on_read = c.strand.wrap(guard(std::bind(&scheduler::on_read, this, std::ref(c), c.generation, _1, _2)));
+        asio::mutable_buffer into(c.read_buffer.data(), c.read_buffer.size());
+        auto& s = *c.socket;
+        issue(c, [&s, into, on_read] () { s.async_read_some(into, on_read); });
+    }
+}
+
+
+void scheduler::issue (connection& c, std::function<void()> socket_operation)
+{
+    // Posting, rather than dispatching, keeps operations in the order they were issued. The socket
+    // belongs to us, so the operation is dropped if we are gone.
+    c.strand.post(guard(socket_operation));
+}
+
+
+void scheduler::deliver_received (
+        connection& c,
+        std::vector<char> bytes,
+        std::size_t n)
+{
+    // The strand keeps the next read from completing before we return, so responses cannot
+    // overtake each other. Handlers may yet enqueue new requests, or terminate their own.
+    if (frames_responses()) {
+        auto collect_frames = c.collect_frames;
+        collect_frames(std::error_code(), n, bytes.data());
+    } else {
+        settle_withdrawn(c);
+        if (not c.in_flight.empty() and not c.in_flight.front()->abandoned) {
+            auto handler = c.in_flight.front()->on_response;
+            handler(to_std_error_code(boost::system::error_code()), n, bytes.data());
+        }
+    }
+
+    // Keep the buffer for a later read.
+    if (c.spare_buffer.empty()) {
+        bytes.resize(parameters_.read_buffer_size);
+        c.spare_buffer.swap(bytes);
+    }
+}
+
+
+bool scheduler::deliver_frame (
+        connection& c,
+        std::size_t generation,
+        std::error_code,
+        std::size_t frame_length,
+        const char* frame)
+{
+    // Stop splitting up bytes from a connection that was already replaced.
+    if (c.generation != generation)
+        return true;
+
+    settle_withdrawn(c);
+
+    // The response to an abandoned request is dropped, and the connection goes on.
+    if (not c.in_flight.empty() and c.in_flight.front()->abandoned) {
+        c.in_flight.front()->active_on = nullptr;
+        c.in_flight.pop_front();
+        // Requests abandoned on a poisoned connection were never counted.
+        if (c.draining > 0 and --c.draining == 0)
+            ++c.drain_attempt;
+        if (not shutting_down_)
+            run_next_request(c);
+        return false;
+    }
+
+    // A complete response terminates the request cleanly, which moves the next request in
+    // flight to the front.
+    if (not c.in_flight.empty()) {
+        auto handler = c.in_flight.front()->on_response;
+        handler(to_std_error_code(boost::system::error_code()), frame_length, frame);
+    }
+
+    return false;
+}
+
+
+void scheduler::connect_socket (connection& c)
+{
+    c.connecting = true;
+    c.next_endpoint = boost::asio::ip::tcp::resolver::iterator();
+    auto attempt = ++c.connect_attempt;
+
+    // Resolution counts against the connect timeout, too.
+    c.connect_timer.expires_from_now(boost::posix_time::milliseconds(parameters_.connect_timeout.count()));
+    c.connect_timer.async_wait(c.strand.wrap(guard(std::bind(&scheduler::on_connect_timeout, this, std::ref(c), c.generation, attempt, _1))));
+    resolver_->async_resolve(target_, c.strand.wrap(guard(std::bind(&scheduler::on_resolve, this, std::ref(c), c.generation, attempt, _1, _2))));
+}
+
+
+void scheduler::on_resolve (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error,
+        boost::asio::ip::tcp::resolver::iterator endpoints)
+{
+    if (c.generation != generation or c.connect_attempt != attempt or shutting_down_)
+        return;
+
+    if (error) {
+        reconnect_later(c);
+    } else {
+        c.next_endpoint = endpoints;
+        try_next_endpoint(c);
+    }
+}
+
+
+void scheduler::try_next_endpoint (connection& c)
+{
+    if (c.next_endpoint == boost::asio::ip::tcp::resolver::iterator()) {
+        reconnect_later(c);
+        return;
+    }
+
+    // Closing the socket abandons any attempt still under way on it.
+    auto attempt = ++c.connect_attempt;
+    c.connect_timer.expires_from_now(boost::posix_time::milliseconds(parameters_.connect_timeout.count()));
+    c.connect_timer.async_wait(c.strand.wrap(guard(std::bind(&scheduler::on_connect_timeout, this, std::ref(c), c.generation, attempt, _1))));
+    auto on_connect = c.strand.wrap(guard(std::bind(&scheduler::on_connect, this, std::ref(c), c.generation, attempt, _1)));
+    auto endpoint = *c.next_endpoint++;
+    auto& s = *c.socket;
+    issue(c, [&s, endpoint, on_connect] () {
+        s.close();
+        s.async_connect(endpoint, on_connect);
+    });
+}
+
+
+void scheduler::on_connect (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error)
+{
+    if (c.generation != generation or c.connect_attempt != attempt or shutting_down_)
+        return;
+
+    if (error) {
+        try_next_endpoint(c);
+    } else {
+        ++c.connect_attempt;
+        c.connect_timer.cancel();
+        c.connecting = false;
+        c.failed_connects = 0;
+        c.last_activity = std::chrono::steady_clock::now();
+        if (parameters_.warm_up) {
+            send_ping(c);
         } else {
-            handle_socket_error(error, std::move(serialize));
+            if (parameters_.keepalive_interval.count() > 0)
+                arm_keepalive(c, parameters_.keepalive_interval);
+            run_next_request(c);
         }
     }
 }
 
 
-void scheduler::connect_socket ()
+void scheduler::on_connect_timeout (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error)
+{
+    if (error or c.generation != generation or c.connect_attempt != attempt or shutting_down_)
+        return;
+
+    try_next_endpoint(c);
+}
+
+
+void scheduler::reconnect_later (connection& c)
+{
+    // Exponential backoff, less a random part of up to half of it.
+    std::size_t doublings = std::min<std::size_t>(c.failed_connects++, 16);
+    auto backoff = std::min<long long>(
+            static_cast<long long>(parameters_.reconnect_backoff.count()) << doublings,
+            parameters_.max_reconnect_backoff.count());
+    std::uniform_int_distribution<long long> jitter(0, backoff / 2);
+    auto delay = backoff - jitter(c.jitter);
+
+    auto attempt = ++c.connect_attempt;
+    auto& s = *c.socket;
+    issue(c, [&s] () { s.close(); });
+    c.connect_timer.expires_from_now(boost::posix_time::milliseconds(delay));
+    c.connect_timer.async_wait(c.strand.wrap(guard(std::bind(&scheduler::on_reconnect_due, this, std::ref(c), c.generation, attempt, _1))));
+}
+
+
+void scheduler::on_reconnect_due (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error)
+{
+    if (error or c.generation != generation or c.connect_attempt != attempt or shutting_down_)
+        return;
+
+    connect_socket(c);
+}
+
+
+void scheduler::send_ping (connection& c)
+{
+    // The ping takes the socket as a request would, so its answer is matched to it in order.
+    message::handler answered = std::bind(&scheduler::on_ping_answered, this, std::ref(c), c.generation, _1, _2, _3);
+    auto collect_answer = message::make_buffering_handler(answered);
+    auto ping = std::make_shared<enqueued_request>(
+            message::wire_package(message::code::PingRequest, std::string()).release(),
+            [collect_answer] (std::error_code error, std::size_t n, const char* data) mutable {
+                collect_answer(error, n, data);
+            });
+    ping->active_on = &c;
+    c.in_flight.push_back(ping);
+    c.pinging = true;
+    c.writing = true;
+    write_from(c, ping, 0);
+    arm_keepalive(c, parameters_.connect_timeout);
+}
+
+
+bool scheduler::on_ping_answered (
+        connection& c,
+        std::size_t generation,
+        std::error_code error,
+        std::size_t n,
+        const char* data)
+{
+    // Socket errors recycle the connection by themselves.
+    if (error or c.generation != generation or not c.pinging or shutting_down_)
+        return true;
+
+    assert(not c.in_flight.empty());
+    auto ping = c.in_flight.front();
+    if (message::verify_code(message::code::PingResponse, n, data)) {
+        ping->active_on = nullptr;
+        c.in_flight.pop_front();
+        c.pinging = false;
+        if (parameters_.keepalive_interval.count() > 0)
+            arm_keepalive(c, parameters_.keepalive_interval);
+        else
+            ++c.keepalive_attempt;
+        run_next_request(c);
+    } else {
+        // Whatever was received, the socket is out of step with the node.
+        ping->abandoned = true;
+        c.poisoned = true;
+        auto& s = *c.socket;
+        issue(c, [&s] () { s.cancel(); });
+    }
+    return true;
+}
+
+
+void scheduler::arm_keepalive (connection& c, std::chrono::milliseconds wait)
+{
+    auto attempt = ++c.keepalive_attempt;
+    c.keepalive_timer.expires_from_now(boost::posix_time::milliseconds(wait.count()));
+    c.keepalive_timer.async_wait(c.strand.wrap(guard(std::bind(&scheduler::on_keepalive_due, this, std::ref(c), c.generation, attempt, _1))));
+}
+
+
+void scheduler::on_keepalive_due (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error)
+{
+    if (error or c.generation != generation or c.keepalive_attempt != attempt or shutting_down_ or c.poisoned)
+        return;
+
+    if (c.pinging) {
+        // The ping went unanswered; recycle the socket as soon as its outstanding operation returns.
+        c.in_flight.front()->abandoned = true;
+        c.poisoned = true;
+        auto& s = *c.socket;
+        issue(c, [&s] () { s.cancel(); });
+        return;
+    }
+
+    auto idle_for = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - c.last_activity);
+    bool idle = c.in_flight.empty() and not c.writing;
+    if (idle and idle_for >= parameters_.keepalive_interval)
+        send_ping(c);
+    else if (idle)
+        arm_keepalive(c, parameters_.keepalive_interval - idle_for);
+    else
+        arm_keepalive(c, parameters_.keepalive_interval);
+}
+
+
+bool scheduler::frames_responses () const
 {
-    resolver::iterator endpoint_iterator = resolver_->resolve(target_);
-    resolver::iterator end;
+    return parameters_.pipeline_depth > 1 or parameters_.drain_timeout.count() > 0;
+}
+
 
-    boost::system::error_code error = boost::asio::error::host_not_found;
-    while (error && endpoint_iterator != end)
-    {
-        socket_->close();
-        socket_->connect(*endpoint_iterator++, error);
+void scheduler::drain (connection& c, enqueued_request& request)
+{
+    // The response will be dropped upon arrival, so long as it arrives in time.
+    request.abandoned = true;
+    if (c.draining++ == 0) {
+        auto attempt = ++c.drain_attempt;
+        c.drain_timer.expires_from_now(boost::posix_time::milliseconds(parameters_.drain_timeout.count()));
+        c.drain_timer.async_wait(c.strand.wrap(guard(std::bind(&scheduler::on_drain_due, this, std::ref(c), c.generation, attempt, _1))));
     }
+}
+
+
+void scheduler::on_drain_due (
+        connection& c,
+        std::size_t generation,
+        std::size_t attempt,
+        const boost::system::error_code& error)
+{
+    if (error or c.generation != generation or c.drain_attempt != attempt or shutting_down_ or c.poisoned)
+        return;
+
+    // Responses still outstanding may never come; reconnect after all.
+    c.poisoned = true;
+    auto& s = *c.socket;
+    issue(c, [&s] () { s.cancel(); });
+}
+
 
-    if (error)
-        throw boost::system::system_error(error);
+void scheduler::recycle (connection& c)
+{
+    // The connection may still carry a late reply to an abandoned request. We need to completely
+    // kill and reconnect the socket, to avoid delivering it to the next request. Whatever is
+    // still outstanding on the old socket belongs to the old generation.
+    ++c.generation;
+    c.writing = false;
+    c.reading = false;
+    c.poisoned = false;
+    c.pinging = false;
+    c.draining = 0;
+    ++c.drain_attempt;
+    start_framing(c);
+
+    auto& s = *c.socket;
+    issue(c, [&s] () {
+        s.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+        s.close();
+    });
+
+    // Requests wait in the queue until the socket is connected again.
+    if (not shutting_down_)
+        connect_socket(c);
+}
+
+
+void scheduler::start_framing (connection& c)
+{
+    message::handler deliver_frames = std::bind(&scheduler::deliver_frame, this, std::ref(c), c.generation, _1, _2, _3);
+    c.collect_frames = message::make_buffering_handler(deliver_frames);
 }
 
 
-void scheduler::handle_socket_error (const boost::system::error_code& error, boost::unique_lock<boost::mutex> serialized)
+void scheduler::settle (connection& c, const std::shared_ptr<enqueued_request>& request)
 {
-    assert(serialized);
-    if (error == boost::asio::error::operation_aborted) {
-        // For this error, we operate under the assumption that the request terminated with a
-        // dirty connection. We need to completely kill and reconnect the socket, to avoid late
-        // replies.
-        //
-        active_request_.reset();
-        socket_->shutdown(boost::asio::ip::tcp::socket::shutdown_both);
-        socket_->close();
-        connect_socket();
+    // Only once, and only while the connection still carries the request.
+    if (request->settled or request->active_on != &c)
+        return;
+    request->settled = true;
 
+    if (not request->withdrawn_dirty and c.in_flight.front() == request) {
+        // The response is complete, so whatever arrives next belongs to the request behind this
+        // one. Make room for another.
+        request->active_on = nullptr;
+        c.in_flight.pop_front();
         if (not shutting_down_)
-            run_next_request();
+            run_next_request(c);
+    } else if (parameters_.drain_timeout.count() > 0 and answered_in_one_frame(request->data)) {
+        // The response is recognizable, so it can be skipped without losing our place.
+        drain(c, *request);
     } else {
-        // An actual error occurred, and we need to inform the application layer.
-        //
-        auto handler = active_request_->second;
-#if _MSC_VER >= 1600 && _MSC_VER < 1800
-        auto error_code = std::make_error_code(static_cast<std::errc::errc>(error.value()));
-#else
-        auto error_code = std::make_error_code(static_cast<std::errc>(error.value()));
-#endif
+        // Anything written after this request would receive its reply. The connection will be
+        // recycled as soon as the outstanding operation returns.
+        request->abandoned = true;
+        c.poisoned = true;
+        auto& s = *c.socket;
+        issue(c, [&s] () { s.cancel(); });
+    }
+}
+
+
+void scheduler::settle_withdrawn (connection& c)
+{
+    // Requests terminated from another thread may not have been settled yet. Whatever is
+    // received now must not reach them.
+    while (not c.in_flight.empty() and c.in_flight.front()->withdrawn and not c.in_flight.front()->settled)
+        settle(c, c.in_flight.front());
+}
+
+
+void scheduler::handle_socket_error (connection& c, const boost::system::error_code& error)
+{
+    std::deque<std::shared_ptr<enqueued_request>> failed_requests;
+    failed_requests.swap(c.in_flight);
+    for (auto r = failed_requests.begin(); r != failed_requests.end(); ++r)
+        (*r)->active_on = nullptr;
+
+    // Whatever happened, the connection can no longer be trusted to be in step with the server.
+    // Replace it before anything else, so that the next request can proceed.
+    recycle(c);
+
+    // Abandoned requests terminated with a dirty connection, and withdrawn ones were terminated
+    // anyway; their owners already know. Anyone else shared the connection with them, or met an
+    // actual error, and we need to inform the application layer.
+    std::error_code reported_error = (error == boost::asio::error::operation_aborted)
+            ? std::make_error_code(std::errc::connection_aborted)
+            : to_std_error_code(error);
+    for (auto r = failed_requests.begin(); r != failed_requests.end(); ++r)
+        if (not (*r)->abandoned and not (*r)->withdrawn)
+            // The handler may (actually: should) decide to terminate the request -- it must succeed.
+            (*r)->on_response(reported_error, 0, "");
+}
+
+
+void scheduler::take_submissions ()
+{
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    if (shutting_down_)
+        return;
 
-        // The handler may (actually: should) decide to terminate the request -- it must succeed.
-        serialized.unlock();
-        handler(error_code, 0, "");
+    // Taking the queue under the lock keeps batches in order, should several threads run ios.
+    auto submitted = submissions_.take_all();
+    for (auto r = submitted.begin(); r != submitted.end(); ++r) {
+        if (not (*r)->withdrawn) {
+            auto& queue = pending_requests_[(*r)->priority_class];
+            (*r)->queue_position = queue.insert(queue.end(), *r);
+            (*r)->queued = true;
+        } else {
+            leave_queue((*r)->priority_class);
+        }
     }
+    bool pending = requests_pending();
+    serialize.unlock();
+
+    // Each connection decides on its own strand whether it can take a request; those which
+    // cannot will take one once they can.
+    if (pending)
+        for (auto c = connections_.begin(); c != connections_.end(); ++c)
+            (*c)->strand.post(guard(std::bind(&scheduler::run_next_request, this, std::ref(**c))));
 }
 
 
-void scheduler::run_next_request ()
+void scheduler::run_next_request (connection& c)
 {
-    if (not pending_requests_.empty()) {
-        active_request_ = pending_requests_.front();
-        pending_requests_.pop_front();
-        auto on_write = std::bind(&scheduler::on_write, this, active_request_, _1, _2);
-        asio::async_write(*socket_, asio::buffer(active_request_->first), on_write);
-    } else {
-        active_request_.reset();
+    // Writes on one socket must not interleave; the next one will be started once this completes.
+    bool accepts_request = not c.writing and not c.poisoned and not c.connecting and not c.pinging
+            and c.in_flight.size() < parameters_.pipeline_depth;
+    if (not accepts_request)
+        return;
+
+    boost::unique_lock<boost::mutex> serialize(mutex_);
+    if (parameters_.max_queue_wait.count() > 0) {
+        // Every request waits equally long at most, so the expired ones are all at the front.
+        auto now = std::chrono::steady_clock::now();
+        for (auto q = pending_requests_.begin(); q != pending_requests_.end(); ++q) {
+            while (not q->empty() and q->front()->deadline < now) {
+                auto expired = q->front();
+                q->pop_front();
+                leave_queue(expired->priority_class);
+                expired->queued = false;
+                ios_.post(guard(std::bind(&scheduler::report_expiry, this, expired)));
+            }
+        }
+    }
+
+    if (not requests_pending())
+        return;
+
+    auto& queue = next_queue();
+    auto next_request = queue.front();
+    queue.pop_front();
+    leave_queue(next_request->priority_class);
+    next_request->queued = false;
+    next_request->active_on = &c;
+    serialize.unlock();
+
+    // The request may be terminated from here on; the termination will be settled on our strand.
+    c.in_flight.push_back(next_request);
+    c.writing = true;
+    write_from(c, next_request, 0);
+}
+
+
+bool scheduler::requests_pending () const
+{
+    for (auto q = pending_requests_.begin(); q != pending_requests_.end(); ++q)
+        if (not q->empty())
+            return true;
+    return false;
+}
+
+
+scheduler::request_queue& scheduler::next_queue ()
+{
+    if (pending_requests_.size() == 1)
+        return pending_requests_.front();
+
+    // Smooth weighted round robin: each class with requests waiting earns its weight, and the
+    // class owed most pays what all of them earned for its turn. Classes thus take turns in
+    // proportion to their weights, interleaved rather than in bursts.
+    const std::size_t none = pending_requests_.size();
+    std::size_t chosen = none;
+    long long earned = 0;
+    for (std::size_t k = 0; k < pending_requests_.size(); ++k) {
+        if (pending_requests_[k].empty())
+            continue;
+        class_credit_[k] += parameters_.class_weights[k];
+        earned += parameters_.class_weights[k];
+        if (chosen == none or class_credit_[k] > class_credit_[chosen])
+            chosen = k;
     }
+
+    assert(chosen != none);
+    class_credit_[chosen] -= earned;
+    return pending_requests_[chosen];
 }
 
 
-void scheduler::option_to_terminate_request::dequeue_thread_safely ()
+void scheduler::report_expiry (const std::shared_ptr<enqueued_request>& request)
 {
-    // TODO: What if this request just became active? Is that possible?
-    boost::unique_lock<boost::mutex> serialize(pool_.mutex_);
-    pool_.pending_requests_.erase(queue_position_);
-    pool_.request_dequeued_.notify_one();
+    // We are called through ios, as we cannot report while holding the lock.
+    if (request->withdrawn or shutting_down_)
+        return;
+
+    request->on_response(make_error_code(communication_failure::response_timeout), 0, "");
 }
 
 
 void scheduler::option_to_terminate_request::exercise (bool connection_is_dirty)
 {
     boost::unique_lock<boost::mutex> serialize(this->mutex_);
-    
-    if (not exercised_) {
-        if (pool_.active_request_->first == this_request_->first) {
-            if (not connection_is_dirty) {
-                boost::unique_lock<boost::mutex> serialize(pool_.mutex_);
-                if (not pool_.shutting_down_)
-                    pool_.run_next_request();
-            }
-            pool_.socket_->cancel();
-        } else {
-            auto dequeue = std::bind(&option_to_terminate_request::dequeue_thread_safely, shared_from_this());
-            pool_.ios_.post(dequeue);
-        }
+
+    // Once the scheduler is gone, so is every trace of the request.
+    if (not exercised_ and pool_lifeline_->enter()) {
         exercised_ = true;
+        auto& request = *this_request_;
+
+        // Only a request still waiting is ours to remove. One taken by a connection belongs to
+        // its strand, which is told of the termination instead.
+        boost::unique_lock<boost::mutex> serialize_pool(pool_.mutex_);
+        if (request.queued) {
+            pool_.pending_requests_[request.priority_class].erase(request.queue_position);
+            pool_.leave_queue(request.priority_class);
+            request.queued = false;
+        }
+        request.withdrawn_dirty = connection_is_dirty;
+        request.withdrawn = true;
+        connection* carrier = request.active_on;
+        serialize_pool.unlock();
+
+        // Within a response handler we run on the strand already, and settle at once.
+        if (carrier)
+            carrier->strand.dispatch(pool_.guard(std::bind(&scheduler::settle, &pool_, std::ref(*carrier), this_request_)));
+        pool_lifeline_->leave();
     }
 }
 
@@ -1,12 +1,23 @@
 #pragma once
+#include <boost/asio/deadline_timer.hpp>
 #include <boost/asio/io_service.hpp>
 #include <boost/asio/ip/tcp.hpp>
-#include <boost/asio/streambuf.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <riak/message.hxx>
 #include <riak/transport.hxx>
+#include <riak/transports/single_serial_socket/pool_parameters.hxx>
+#include <riak/transports/single_serial_socket/submission_queue.hxx>
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <list>
+#include <memory>
+#include <random>
 #include <string>
+#include <vector>
 
 namespace riak {
   namespace transport {
@@ -23,6 +34,44 @@ namespace riak {
 		namespace single_serial_socket {
 //=============================================================================
 
+/*!
+ * Delivers requests serially along each of a fixed set of sockets to one Riak node. Requests
+ * wait in a single queue shared by all sockets; whichever connection becomes free first takes
+ * the request at the head of that queue.
+ *
+ * If pipelining is enabled, a connection is free while fewer than pipeline_depth requests are in
+ * flight upon it. Responses are then split into frames and handed to the in-flight requests in
+ * the order those were written. A request terminated dirty while in flight poisons its
+ * connection: the connection is recycled, and every other request in flight upon it fails
+ * with std::errc::connection_aborted. Unless draining is enabled, in which case the response to
+ * such a request is read and discarded, and the connection kept.
+ *
+ * Sockets are connected asynchronously, both at first and after any failure. A socket which
+ * cannot connect is retried after a growing, jittered backoff; requests wait in the queue for
+ * whichever socket connects first.
+ *
+ * Delivery takes no lock: each request is pushed onto a lock-free submission queue, which is
+ * drained into the shared queue by a handler run on ios. No request is written before ios runs.
+ *
+ * Any number of threads may run ios. Everything a connection does runs on its own strand: every
+ * operation upon its socket, every completion of one, its timers, and the handing out of its
+ * responses. The connections share only the queues of waiting requests, and the scheduler's lock
+ * guards those alone; a connection takes it just long enough to take its next request. Completions
+ * on different connections thus run in parallel, and response handlers never run under the lock.
+ *
+ * A request terminated from its own response handler is settled with its connection at once.
+ * Terminated from any other thread, it is settled on its connection's strand shortly after, and
+ * hears nothing more meanwhile.
+ *
+ * Sockets may ping the node upon connecting, and whenever left idle; see pool_parameters. A ping
+ * occupies its socket like any request, and one left unanswered poisons it.
+ *
+ * The number of requests waiting for a socket may be bounded; see pool_parameters for what
+ * becomes of requests delivered beyond the bound. Requests may also be given a deadline, past
+ * which they are dropped from the queue rather than sent.
+ *
+ * Requests of different priority classes wait in separate queues, served by weighted round robin.
+ */
 class scheduler
       : public std::enable_shared_from_this<scheduler>
 {
@@ -34,49 +83,324 @@ class scheduler
      * \param ios must survive through the destruction of this transport.
      * \param s will be the physical socket used in this pool.
      * \param resolver will be used to resolve node_address and port upon every reconnection.
-     * \post A connection to node_address is made eagerly at the given location. The transport is ready
-     *     to deliver requests, or construction will have thrown.
+     * \param parameters determines how requests share each connection.
+     * \post Connection to node_address has begun, but need not have completed. The transport is
+     *     ready to accept requests, which will wait until a socket is connected.
      */
     scheduler (
             const std::string& node_address,
             uint16_t port,
             boost::asio::io_service& ios,
             std::unique_ptr<socket> s,
-            const std::shared_ptr<resolver>& resolver);
-    
+            const std::shared_ptr<resolver>& resolver,
+            const pool_parameters& parameters = pool_parameters());
+
+    /*!
+     * As above, but requests are spread among all of the given sockets.
+     * \param sockets must contain at least one socket. Each is connected at once.
+     */
+    scheduler (
+            const std::string& node_address,
+            uint16_t port,
+            boost::asio::io_service& ios,
+            std::vector<std::unique_ptr<socket>> sockets,
+            const std::shared_ptr<resolver>& resolver,
+            const pool_parameters& parameters = pool_parameters());
+
+    /*!
+     * Fails every request outstanding, and waits for any handler of this scheduler running on
+     * another thread to return. Handlers which ios runs later find the scheduler gone, and do
+     * nothing. Hence this must not be called from within a response handler.
+     */
     virtual ~scheduler ();
 
+    /*! Delivers a request of the first priority class. */
     virtual transport::option_to_terminate_request deliver (
-            const std::string& r,
+            std::string r,
+            transport::response_handler h);
+
+    /*!
+     * As deliver, but the request waits for a socket among those of the given class.
+     * \param priority_class must be less than the number of class weights in the pool parameters.
+     */
+    transport::option_to_terminate_request deliver_as (
+            std::size_t priority_class,
+            std::string r,
             transport::response_handler h);
-    
+
+    /*!
+     * \return the number of requests delivered and not yet taken by a socket. Callers may shed load
+     *     as this grows, before latency does.
+     */
+    std::size_t queued_requests () const;
+
+    /*! As above, counting only requests of the given class. */
+    std::size_t queued_requests (std::size_t priority_class) const;
+
   private:
     class option_to_terminate_request;
     friend class option_to_terminate_request;
-    typedef std::pair<const std::string, transport::response_handler> enqueued_request;
-    
+    struct enqueued_request;
+    struct connection;
+    class lifeline;
+    template <typename Handler> class guarded_handler;
+
+    typedef std::list<std::shared_ptr<enqueued_request>> request_queue;
+
     boost::asio::ip::tcp::resolver::query target_;
     boost::asio::io_service& ios_;
-    
+    const pool_parameters parameters_;
+
+    /*! Shared with every handler given to ios, which may be run after we are gone. */
+    std::shared_ptr<lifeline> lifeline_;
+
+    /*! Requests delivered but not yet taken into pending_requests_. Taken only under mutex_. */
+    submission_queue<std::shared_ptr<enqueued_request>> submissions_;
+
+    /*! Guards the queues below, and what enqueued_request says is guarded by it; nothing else. */
     mutable boost::mutex mutex_;
-    std::unique_ptr<socket> socket_;
     std::shared_ptr<resolver> resolver_;
-    boost::asio::streambuf read_buffer_;
-    std::shared_ptr<enqueued_request> active_request_;
-    boost::condition_variable active_request_finished_;
-    
-    typedef std::list<std::shared_ptr<enqueued_request>> request_queue;
-    request_queue pending_requests_;
-    boost::condition_variable request_dequeued_;
-    
-    bool shutting_down_;
-    
-    void on_read (std::shared_ptr<enqueued_request>, const boost::system::error_code&, size_t);
-    void on_write (std::shared_ptr<enqueued_request>, const boost::system::error_code&, size_t);
-    void run_next_request ();
-    void handle_socket_error (const boost::system::error_code&, boost::unique_lock<boost::mutex>);
-    void connect_socket ();
-    transport::option_to_terminate_request enqueue (enqueued_request&, const request_queue::iterator&);
+    std::vector<std::unique_ptr<connection>> connections_;
+    /*! One queue per priority class. */
+    std::vector<request_queue> pending_requests_;
+
+    /*! What each class is owed in the weighted round robin among queues. */
+    std::vector<long long> class_credit_;
+
+    /*! Read without the lock by deliver; set only under it. */
+    std::atomic<bool> shutting_down_;
+
+    /*! Requests delivered and not yet written or withdrawn. Raised by deliver without the lock;
+        lowered only under it, when room_in_queue_ is signalled. */
+    std::atomic<std::size_t> queued_;
+    std::unique_ptr<std::atomic<std::size_t>[]> queued_in_class_;
+    boost::condition_variable room_in_queue_;
+
+    /*! Threads waiting in deliver for room_in_queue_, which the destructor waits to see leave. */
+    std::size_t blocked_submitters_;
+    boost::condition_variable submitters_left_;
+
+    /*! \return h, made to do nothing if called after this scheduler is destroyed. */
+    template <typename Handler> guarded_handler<Handler> guard (Handler h) const;
+
+    void on_read (connection&, std::size_t generation, const boost::system::error_code&, size_t);
+    void on_write (connection&, std::size_t generation, std::shared_ptr<enqueued_request>, std::size_t offset, const boost::system::error_code&, size_t);
+    void write_from (connection&, std::shared_ptr<enqueued_request>, std::size_t offset);
+    void listen (connection&);
+    void issue (connection&, std::function<void()> socket_operation);
+    void deliver_received (connection&, std::vector<char> bytes, std::size_t n);
+    bool deliver_frame (connection&, std::size_t generation, std::error_code, std::size_t, const char*);
+    void take_submissions ();
+    bool admit (std::size_t priority_class);
+    bool called_from_ios () const;
+    void leave_queue (std::size_t priority_class);
+    bool requests_pending () const;
+    request_queue& next_queue ();
+    void report_expiry (const std::shared_ptr<enqueued_request>&);
+    void run_next_request (connection&);
+    void settle (connection&, const std::shared_ptr<enqueued_request>&);
+    void settle_withdrawn (connection&);
+    void handle_socket_error (connection&, const boost::system::error_code&);
+    void recycle (connection&);
+    void start_framing (connection&);
+    void connect_socket (connection&);
+    void on_resolve (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&, boost::asio::ip::tcp::resolver::iterator);
+    void try_next_endpoint (connection&);
+    void on_connect (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&);
+    void on_connect_timeout (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&);
+    void reconnect_later (connection&);
+    void on_reconnect_due (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&);
+    void send_ping (connection&);
+    bool on_ping_answered (connection&, std::size_t generation, std::error_code, std::size_t, const char*);
+    void arm_keepalive (connection&, std::chrono::milliseconds);
+    void on_keepalive_due (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&);
+    bool frames_responses () const;
+    void drain (connection&, enqueued_request&);
+    void on_drain_due (connection&, std::size_t generation, std::size_t attempt, const boost::system::error_code&);
+};
+
+/*!
+ * A request as held by the scheduler. Its place in the queues is guarded by the scheduler's
+ * mutex; once taken by a connection, the request belongs to that connection's strand. Whoever
+ * terminates it sets withdrawn, and tells the strand.
+ */
+struct scheduler::enqueued_request
+{
+    enqueued_request (std::string d, transport::response_handler h)
+      : data(std::move(d))
+      , on_response(h)
+      , deadline(std::chrono::steady_clock::time_point::max())
+      , priority_class(0)
+      , queued(false)
+      , active_on(nullptr)
+      , abandoned(false)
+      , settled(false)
+      , withdrawn(false)
+      , withdrawn_dirty(false)
+    {   }
+
+    const std::string data;
+    const transport::response_handler on_response;
+
+    /*! Once past, the request is dropped rather than taken by a socket. */
+    std::chrono::steady_clock::time_point deadline;
+
+    /*! Selects the queue in which the request waits. */
+    std::size_t priority_class;
+
+    /*! Valid only while queued is true. Both guarded by the scheduler's mutex. */
+    request_queue::iterator queue_position;
+    bool queued;
+
+    /*! The connection carrying this request, or null if the request is not being transmitted. Set
+        under the scheduler's mutex, and cleared on the connection's strand. */
+    std::atomic<connection*> active_on;
+
+    /*! Set when the request was terminated dirty while in flight; its connection must be recycled.
+        Used only on the strand of the connection carrying the request. */
+    bool abandoned;
+
+    /*! Set once the connection carrying the request has dealt with its termination. Used only on
+        that connection's strand. */
+    bool settled;
+
+    /*! Set once the request is terminated, so that it is dropped if still in the submission queue,
+        and hears nothing further from the connection carrying it. */
+    std::atomic<bool> withdrawn;
+
+    /*! Whether the request was terminated with its response incomplete. */
+    std::atomic<bool> withdrawn_dirty;
+};
+
+/*!
+ * One socket of the pool, together with the requests it carries. Used only on its strand, but
+ * for its construction and the scheduler's destruction.
+ */
+struct scheduler::connection
+{
+    connection (std::unique_ptr<single_serial_socket::socket> s, boost::asio::io_service& ios)
+      : socket(std::move(s))
+      , generation(0)
+      , writing(false)
+      , reading(false)
+      , poisoned(false)
+      , connecting(false)
+      , connect_attempt(0)
+      , failed_connects(0)
+      , connect_timer(ios)
+      , pinging(false)
+      , keepalive_attempt(0)
+      , keepalive_timer(ios)
+      , draining(0)
+      , drain_attempt(0)
+      , drain_timer(ios)
+      , jitter(static_cast<std::minstd_rand::result_type>(reinterpret_cast<std::uintptr_t>(this)))
+      , strand(ios)
+    {   }
+
+    std::unique_ptr<single_serial_socket::socket> socket;
+
+    /*! The socket reads into this buffer. Once filled, it is handed to the client, and the spare
+        buffer takes its place; the two swap back and forth without further allocation. */
+    std::vector<char> read_buffer;
+    std::vector<char> spare_buffer;
+
+    /*! While pipelining, splits what is received into frames. Replaced upon every recycle. */
+    message::buffering_handler collect_frames;
+
+    /*! Requests written (or being written) on this socket, oldest first. The oldest receives
+        whatever the socket reads next. */
+    std::deque<std::shared_ptr<enqueued_request>> in_flight;
+
+    /*! Incremented on every recycle, so that completions of operations issued on the previous
+        socket can be recognized and ignored. */
+    std::size_t generation;
+
+    bool writing;
+    bool reading;
+
+    /*! Set when a request in flight was abandoned; the connection must be recycled. */
+    bool poisoned;
+
+    /*! Set until the socket is connected; nothing is written on it meanwhile. */
+    bool connecting;
+
+    /*! Identifies the current step of connection (resolution, an address being tried, or a wait
+        before reconnecting), so that completions belonging to earlier steps can be ignored. */
+    std::size_t connect_attempt;
+
+    /*! Consecutive failures to connect, which lengthen the wait before the next attempt. */
+    std::size_t failed_connects;
+
+    /*! The addresses of the node not yet tried in the current attempt. */
+    boost::asio::ip::tcp::resolver::iterator next_endpoint;
+
+    /*! Bounds each step of connection, or delays the next attempt after a failure. */
+    boost::asio::deadline_timer connect_timer;
+
+    /*! Set while a ping is in flight; the socket takes no requests meanwhile. */
+    bool pinging;
+
+    /*! When the socket last completed a read or a write, or connected. */
+    std::chrono::steady_clock::time_point last_activity;
+
+    /*! Identifies the current wait of keepalive_timer, so that earlier completions can be ignored. */
+    std::size_t keepalive_attempt;
+
+    /*! Counts down either the idle time before the next ping, or the time left to answer one. */
+    boost::asio::deadline_timer keepalive_timer;
+
+    /*! The number of abandoned requests in flight, whose responses are to be discarded. */
+    std::size_t draining;
+
+    /*! Identifies the current wait of drain_timer, so that earlier completions can be ignored. */
+    std::size_t drain_attempt;
+
+    /*! Bounds the wait for the responses to abandoned requests. */
+    boost::asio::deadline_timer drain_timer;
+
+    /*! Spreads out reconnection attempts of sockets which failed together. */
+    std::minstd_rand jitter;
+
+    /*! Runs every operation upon the socket, and every completion of one, one at a time. */
+    boost::asio::io_service::strand strand;
+};
+
+/*!
+ * Tells handlers run through ios whether their scheduler still exists, and keeps it in existence
+ * while they run.
+ */
+class scheduler::lifeline
+{
+  public:
+    lifeline ()
+      : ended_(false)
+      , running_(0)
+    {   }
+
+    /*! \return true if the scheduler lives, in which case it does so until leave is called. */
+    bool enter () {
+        ++running_;
+        if (not ended_)
+            return true;
+        --running_;
+        return false;
+    }
+
+    void leave () {
+        --running_;
+    }
+
+    /*! Called by the scheduler upon destruction. Returns once no caller of enter remains. */
+    void end () {
+        ended_ = true;
+        while (running_ > 0)
+            boost::this_thread::yield();
+    }
+
+  private:
+    std::atomic<bool> ended_;
+    std::atomic<std::size_t> running_;
 };
 
 class scheduler::option_to_terminate_request
@@ -86,30 +410,28 @@ class scheduler::option_to_terminate_request
     virtual ~option_to_terminate_request () {
         exercise(false);
     }
-    
+
     virtual void exercise (bool connection_is_dirty);
-    
+
     option_to_terminate_request (
             scheduler& p,
-            std::shared_ptr<scheduler::enqueued_request>& r,
-            const scheduler::request_queue::iterator pos)
+            std::shared_ptr<scheduler::enqueued_request>& r)
       : pool_(p)
+      , pool_lifeline_(p.lifeline_)
       , this_request_(r)
-      , queue_position_(pos)
       , exercised_(false)
     {   }
-    
+
   private:
-    // The option cannot be serialized with the scheduler's mutex, because a
-    // response handler will invoke this with that locked. Instead, we rely on
-    // pool_.socket working asynchronously.
+    // Guards only the idempotence of this option. The scheduler's mutex is taken separately,
+    // so the scheduler must never exercise an option while holding its own lock.
     boost::mutex mutex_;
     scheduler& pool_;
+
+    /*! The option may be exercised after pool_ is gone, to no effect. */
+    std::shared_ptr<lifeline> pool_lifeline_;
     std::shared_ptr<scheduler::enqueued_request> this_request_;
-    const scheduler::request_queue::iterator queue_position_;
     bool exercised_;
-    
-    void dequeue_thread_safely ();
 };
 
 //=============================================================================
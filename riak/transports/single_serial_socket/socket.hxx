@@ -1,5 +1,5 @@
 #pragma once
-#include <boost/asio/streambuf.hpp>
+#include <boost/asio/buffer.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 //=============================================================================
@@ -20,13 +20,14 @@ class socket
 
 	typedef std::function<void(const boost::system::error_code&, std::size_t)> ReadHandler;
 	typedef std::function<void(const boost::system::error_code&, std::size_t)> WriteHandler;
+	typedef std::function<void(const boost::system::error_code&)> ConnectHandler;
 
 	virtual void cancel () = 0;
 	virtual void close () = 0;
 	virtual void shutdown (boost::asio::ip::tcp::socket::shutdown_type) = 0;
-	virtual void async_read_some (boost::asio::streambuf&, ReadHandler) = 0;
+	virtual void async_read_some (const boost::asio::mutable_buffer&, ReadHandler) = 0;
 	virtual void async_write_some (const boost::asio::const_buffer&, WriteHandler) = 0;
-	virtual boost::system::error_code connect (const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, boost::system::error_code&) = 0;
+	virtual void async_connect (const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, ConnectHandler) = 0;
 };
 
 //=============================================================================
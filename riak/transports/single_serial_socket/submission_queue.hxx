@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+	namespace transport {
+		namespace single_serial_socket {
+//=============================================================================
+
+/*!
+ * Collects items from any number of threads without locking. A single consumer takes everything
+ * collected at once, in the order it was added.
+ *
+ * Producers push onto a linked stack with compare-and-swap; the consumer detaches the whole stack
+ * with one exchange and reverses it. As nothing is ever popped singly, no node can be reused while
+ * a producer still looks at it.
+ */
+template <typename T>
+class submission_queue
+{
+  public:
+	submission_queue ()
+	  : head_(nullptr)
+	{   }
+
+	~submission_queue () {
+		take_all();
+	}
+
+	/*!
+	 * \return true iff the queue was empty until now. The caller should then see that the consumer
+	 *     calls take_all; other producers can rely on that call.
+	 */
+	bool push (T item) {
+		auto n = new node(std::move(item));
+		n->next = head_.load(std::memory_order_relaxed);
+		while (not head_.compare_exchange_weak(n->next, n, std::memory_order_release, std::memory_order_relaxed))
+			;
+		return n->next == nullptr;
+	}
+
+	/*!
+	 * \return every item pushed since the last call, oldest first.
+	 * \pre No other thread is calling take_all.
+	 */
+	std::vector<T> take_all () {
+		std::vector<T> items;
+		for (node* n = head_.exchange(nullptr, std::memory_order_acquire); n != nullptr; ) {
+			items.push_back(std::move(n->item));
+			node* next = n->next;
+			delete n;
+			n = next;
+		}
+		std::reverse(items.begin(), items.end());
+		return items;
+	}
+
+  private:
+	submission_queue (const submission_queue&);
+	submission_queue& operator= (const submission_queue&);
+
+	struct node
+	{
+		explicit node (T i)
+		  : item(std::move(i))
+		  , next(nullptr)
+		{   }
+
+		T item;
+		node* next;
+	};
+
+	std::atomic<node*> head_;
+};
+
+//=============================================================================
+		}   // namespace single_serial_socket
+	}   // namespace transport
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,48 @@
+#include <test/fixtures/cluster_transport/two_node_cluster.hxx>
+
+using namespace ::testing;
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace fixture {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+two_node_cluster::two_node_cluster ()
+{
+	typedef mock::transport::device::option_to_terminate_request mock_close_option;
+	std::vector<riak::transport::delivery_provider> nodes;
+	for (std::size_t i = 0; i < 2; ++i) {
+		auto record_delivery = [this, i] (const std::string&, riak::transport::response_handler h) {
+			deliveries[i].push_back(h);
+			return riak::transport::option_to_terminate_request(std::bind(&mock_close_option::exercise, &closure_signal));
+		};
+		ON_CALL(devices[i], deliver(_, _)).WillByDefault(Invoke(record_delivery));
+		nodes.push_back(std::bind(&mock::transport::device::deliver, &devices[i], _1, _2));
+	}
+	auto ejection = riak::transport::ejection_parameters()
+			.with_consecutive_failures(2)
+			.with_probe_interval(std::chrono::milliseconds(10));
+	cluster = std::make_shared<riak::transport::cluster::balancer>(nodes, ios, std::chrono::milliseconds(1000), ejection);
+}
+
+
+riak::transport::option_to_terminate_request two_node_cluster::send ()
+{
+	return cluster->deliver("request", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
+}
+
+
+// Defining this explicitly speeds up compilation time.
+two_node_cluster::~two_node_cluster ()
+{   }
+
+//=============================================================================
+		}   // namespace fixture
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,41 @@
+#pragma once
+#include <test/fixtures/log/logs_test_name.hxx>
+#include <test/mocks/transport.hxx>
+#include <riak/transports/cluster/balancer.hxx>
+#include <boost/asio/io_service.hpp>
+#include <memory>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace fixture {
+//=============================================================================
+
+/*!
+ * Two mocked nodes behind one balancer. Each node records the response handlers of requests
+ * delivered to it, so that a test may answer them at will. A node is ejected after two failures
+ * in a row, and probed every 10 ms while ejected.
+ */
+struct two_node_cluster
+       : public logs_test_name
+{
+	two_node_cluster ();
+	virtual ~two_node_cluster ();
+
+	/*! Delivers a request through the balancer, answering to handler. */
+	riak::transport::option_to_terminate_request send ();
+
+	mock::transport::device devices[2];
+	std::vector<riak::transport::response_handler> deliveries[2];
+	::testing::NiceMock<mock::transport::device::option_to_terminate_request> closure_signal;
+	::testing::NiceMock<mock::transport::device::response_handler> handler;
+	boost::asio::io_service ios;
+	std::shared_ptr<riak::transport::cluster::balancer> cluster;
+};
+
+//=============================================================================
+		}   // namespace fixture
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
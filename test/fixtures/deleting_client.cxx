@@ -12,7 +12,10 @@ using std::placeholders::_3;
 
 deleting_client::deleting_client ()
   : response_handler(std::bind(&mock_response_handler::execute, &response_handler_mock, _1))
-{   }
+{
+    // Each test here sends exactly one request.
+    EXPECT_CALL(transport, deliver(::testing::_, ::testing::_));
+}
 
 
 // Defining this explicitly speeds up compilation time.
@@ -7,7 +7,10 @@ namespace riak {
 //=============================================================================
 
 getting_client::getting_client ()
-{   }
+{
+    // Each test here sends exactly one request.
+    EXPECT_CALL(transport, deliver(::testing::_, ::testing::_));
+}
 
 
 // Defining this explicitly speeds up compilation time.
@@ -25,12 +25,38 @@ using std::placeholders::_2;
 using std::placeholders::_3;
 
 riak_client_with_mocked_transport::riak_client_with_mocked_transport ()
-  : client(std::bind(&mock::transport::device::deliver, &transport, _1, _2), &no_sibling_resolution, ios)
-  , response_handler(std::bind(&::riak::mock::get_request::response_handler::execute, &response_handler_mock, _1, _2, _3))
+  : response_handler(std::bind(&::riak::mock::get_request::response_handler::execute, &response_handler_mock, _1, _2, _3))
+  , delete_response_handler(std::bind(&mock::delete_request::response_handler::execute, &delete_response_handler_mock, _1))
 {
     typedef mock::transport::device::option_to_terminate_request mock_close_option;
-    EXPECT_CALL(transport, deliver(_, _))
-            .WillOnce(DoAll(SaveArg<1>(&send_from_server), Return(std::bind(&mock_close_option::exercise, &closure_signal))));
+    auto record_delivery = [this] (const std::string& r, ::riak::transport::response_handler h) {
+        requests.push_back(r);
+        deliveries.push_back(h);
+        send_from_server = h;
+        return ::riak::transport::option_to_terminate_request(std::bind(&mock_close_option::exercise, &closure_signal));
+    };
+    ON_CALL(transport, deliver(_, _)).WillByDefault(Invoke(record_delivery));
+    start(client::failure_defaults.with_retries_permitted(0));
+}
+
+
+void riak_client_with_mocked_transport::start (const request_failure_parameters& parameters)
+{
+    client.reset();
+    requests.clear();
+    deliveries.clear();
+    client.reset(new riak::client(std::bind(&mock::transport::device::deliver, &transport, _1, _2),
+            &no_sibling_resolution, ios, parameters));
+}
+
+
+void riak_client_with_mocked_transport::run_until_next_delivery ()
+{
+    // Response timeouts would fire eventually; don't wait for them.
+    auto deliveries_made = deliveries.size();
+    ios.reset();
+    while (deliveries.size() == deliveries_made and ios.run_one() > 0)
+        ;
 }
 
 
@@ -2,9 +2,12 @@
 #include <boost/asio/io_service.hpp>
 #include <riak/client.hxx>
 #include <test/fixtures/log/logs_test_name.hxx>
+#include <test/mocks/delete_request.hxx>
 #include <test/mocks/get_request.hxx>
 #include <test/mocks/transport.hxx>
 #include <test/mocks/sibling_resolution.hxx>
+#include <memory>
+#include <vector>
 
 //=============================================================================
 namespace riak {
@@ -12,21 +15,39 @@ namespace riak {
         namespace fixture {
 //=============================================================================
 
+/*!
+ * A client on a mocked transport, which by default sends each request exactly once. Every request
+ * sent is recorded in requests, and may be answered at will through its entry in deliveries;
+ * send_from_server answers the latest.
+ */
 struct riak_client_with_mocked_transport
        : public logs_test_name 
 {
     riak_client_with_mocked_transport ();
     ~riak_client_with_mocked_transport ();
 
+    /*!
+     * Replaces the client with one which fails and retries requests as given. A test which needs
+     * other than the default parameters calls this before anything else.
+     */
+    void start (const request_failure_parameters& parameters);
+
+    /*! Runs the client until it has sent another request, or has nothing left to do. */
+    void run_until_next_delivery ();
+
     typedef mock::get_request::response_handler mock_response_handler;
 
     mock::transport::device transport;
     mock::sibling_resolution sibling_resolution;
     boost::asio::io_service ios;
-    riak::client client;
+    std::unique_ptr<riak::client> client;
     mock_response_handler response_handler_mock;
     ::riak::get_response_handler response_handler;
+    mock::delete_request::response_handler delete_response_handler_mock;
+    ::riak::delete_response_handler delete_response_handler;
 
+    std::vector<std::string> requests;
+    std::vector< ::riak::transport::response_handler> deliveries;
     ::riak::transport::response_handler send_from_server;
     mock::transport::device::option_to_terminate_request closure_signal;
 };
@@ -0,0 +1,45 @@
+#include "reachable_node.hxx"
+#include <boost/bind.hpp>
+#include <gmock/gmock.h>
+
+using namespace ::testing;
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace fixture {
+//=============================================================================
+
+mock::sss::resolver::iterator node_endpoints ()
+{
+	return mock::sss::resolver::iterator::create(boost::asio::ip::tcp::endpoint(), "boo", "bear");
+}
+
+
+void resolve_successfully (mock::sss::resolver& resolver, boost::asio::io_service& ios)
+{
+	auto dns_result = node_endpoints();
+	auto report_later = [&ios, dns_result] (const mock::sss::resolver::query&, mock::sss::resolver::ResolveHandler h) {
+		// std::bind yielded a stack overflow here.
+		std::function<void()> f = boost::bind(h, boost::system::error_code(), dns_result);
+		ios.post(f);
+	};
+	ON_CALL(resolver, async_resolve(_, _)).WillByDefault(Invoke(report_later));
+}
+
+
+void connect_successfully (mock::sss::socket& socket, boost::asio::io_service& ios)
+{
+	typedef boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp> endpoint;
+	auto report_later = [&ios] (const endpoint&, mock::sss::socket::ConnectHandler h) {
+		std::function<void()> f = boost::bind(h, boost::system::error_code());
+		ios.post(f);
+	};
+	ON_CALL(socket, async_connect(_, _)).WillByDefault(Invoke(report_later));
+}
+
+//=============================================================================
+		}   // namespace fixture
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,36 @@
+#pragma once
+#include <test/mocks/transport/single_serial_socket/resolver.hxx>
+#include <test/mocks/transport/single_serial_socket/socket.hxx>
+#include <boost/asio/io_service.hpp>
+
+namespace riak {
+	namespace mock { namespace sss = transport::single_serial_socket; }
+}
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace fixture {
+//=============================================================================
+
+/*!
+ * \return the addresses at which the node is found; we don't care what they are.
+ */
+mock::sss::resolver::iterator node_endpoints ();
+
+/*!
+ * Makes every resolution of the node succeed, as a real resolver would: the result is reported
+ * through ios, not from within the call.
+ */
+void resolve_successfully (mock::sss::resolver&, boost::asio::io_service& ios);
+
+/*!
+ * Makes every connection attempt of the socket succeed, reporting through ios.
+ */
+void connect_successfully (mock::sss::socket&, boost::asio::io_service& ios);
+
+//=============================================================================
+		}   // namespace fixture
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
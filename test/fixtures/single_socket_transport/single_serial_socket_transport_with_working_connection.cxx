@@ -1,4 +1,5 @@
 #include "single_serial_socket_transport_with_working_connection.hxx"
+#include "reachable_node.hxx"
 #include <test/mocks/transport/single_serial_socket/resolver.hxx>
 #include <test/mocks/transport/single_serial_socket/socket.hxx>
 #include <gmock/gmock.h>
@@ -18,14 +19,10 @@ namespace riak {
 single_serial_socket_transport_with_working_connection::single_serial_socket_transport_with_working_connection ()
   : socket(new NiceMock<mock::sss::socket>)
 {
-	// Resolve the target address to something -- we don't care.
-	auto resolver = std::make_shared<NiceMock<mock::sss::resolver>>();
-	auto dns_result = mock::sss::resolver::iterator::create(boost::asio::ip::tcp::endpoint(), "boo", "bear");
-	ON_CALL(*resolver, resolve(_)).WillByDefault(Return(dns_result));
-
 	// Succeed in connecting every time.
-	auto success = boost::system::error_code();
-	ON_CALL(*socket, connect(_, _)).WillByDefault(DoAll(SetArgReferee<1>(success), Return(success)));
+	auto resolver = std::make_shared<NiceMock<mock::sss::resolver>>();
+	resolve_successfully(*resolver, ios);
+	connect_successfully(*socket, ios);
 
 	// Remember the physical pointer to this socket -- the pool must own the canonical (unique_ptr) pointer.
 	std::unique_ptr<NiceMock<mock::sss::socket>> socket_ptr(socket);
@@ -36,6 +33,10 @@ single_serial_socket_transport_with_working_connection::single_serial_socket_tra
 					std::move(socket_ptr),
 					std::static_pointer_cast<single_serial_socket::resolver>(resolver))
 		);
+
+	// Let the connection complete, so that requests are written as soon as they are delivered.
+	ios.poll();
+	ios.reset();
 }
 
 
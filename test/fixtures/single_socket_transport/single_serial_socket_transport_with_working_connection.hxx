@@ -26,10 +26,11 @@ struct single_serial_socket_transport_with_working_connection
 	 */
 	::testing::NiceMock<mock::sss::socket>* const socket;
 
+	/*! Declared before transport, whose timers and strands must be destroyed while it lives. */
+	boost::asio::io_service ios;
+
 	/*! Connected using socket, will always be able to re-connect in case of a connection drop. */
 	std::unique_ptr<riak::transport::single_serial_socket::scheduler> transport;
-
-	boost::asio::io_service ios;
 };
 
 //=============================================================================
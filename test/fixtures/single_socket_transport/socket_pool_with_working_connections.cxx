@@ -0,0 +1,71 @@
+#include "socket_pool_with_working_connections.hxx"
+#include "reachable_node.hxx"
+#include <test/mocks/transport/single_serial_socket/resolver.hxx>
+#include <test/mocks/transport/single_serial_socket/socket.hxx>
+#include <gmock/gmock.h>
+
+using namespace ::testing;
+namespace single_serial_socket = ::riak::transport::single_serial_socket;
+namespace riak {
+	namespace mock { namespace sss = transport::single_serial_socket; }
+}
+
+//=============================================================================
+namespace riak {
+    namespace test {
+        namespace fixture {
+//=============================================================================
+
+socket_pool_with_working_connections::socket_pool_with_working_connections (
+		const riak::transport::pool_parameters& parameters)
+{
+	start(parameters);
+}
+
+
+void socket_pool_with_working_connections::start (const riak::transport::pool_parameters& parameters)
+{
+	// Any transport started before goes first, and takes its sockets with it.
+	transport.reset();
+	sockets.clear();
+
+	// Succeed in connecting every time. The pool must own the canonical (unique_ptr) pointers.
+	auto resolver = std::make_shared<NiceMock<mock::sss::resolver>>();
+	resolve_successfully(*resolver, ios);
+	std::vector<std::unique_ptr<single_serial_socket::socket>> owned_sockets;
+	for (int i = 0; i < 2; ++i) {
+		auto socket = new NiceMock<mock::sss::socket>;
+		connect_successfully(*socket, ios);
+		sockets.push_back(socket);
+		owned_sockets.push_back(std::unique_ptr<single_serial_socket::socket>(socket));
+	}
+
+	transport.reset(
+			new single_serial_socket::scheduler(
+					"wherever", 8000, ios,
+					std::move(owned_sockets),
+					std::static_pointer_cast<single_serial_socket::resolver>(resolver),
+					parameters)
+		);
+
+	// Let the connections complete, so that requests are written as soon as they are taken.
+	run_ready_handlers();
+}
+
+
+void socket_pool_with_working_connections::run_ready_handlers ()
+{
+	ios.poll();
+	ios.reset();
+}
+
+
+socket_pool_with_working_connections::~socket_pool_with_working_connections ()
+{   }
+
+
+//=============================================================================
+        }   // namespace fixture
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
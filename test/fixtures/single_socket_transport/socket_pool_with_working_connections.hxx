@@ -0,0 +1,51 @@
+#pragma once
+#include <test/fixtures/log/logs_test_name.hxx>
+#include <test/mocks/transport/single_serial_socket/socket.hxx>
+#include <riak/transports/single_serial_socket/scheduler.hxx>
+#include <boost/asio/io_service.hpp>
+#include <vector>
+
+namespace riak {
+	namespace mock { namespace sss = transport::single_serial_socket; }
+}
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace fixture {
+//=============================================================================
+
+struct socket_pool_with_working_connections
+       : public logs_test_name
+{
+	explicit socket_pool_with_working_connections (
+			const riak::transport::pool_parameters& parameters = riak::transport::pool_parameters());
+	virtual ~socket_pool_with_working_connections ();
+
+	/*!
+	 * Replaces the transport with one made under the given parameters, on fresh sockets. A test
+	 * which needs other than the default parameters calls this before anything else.
+	 */
+	void start (const riak::transport::pool_parameters& parameters);
+
+	/*! Runs whatever the transport has left to ios, such as taking the requests delivered to it. */
+	void run_ready_handlers ();
+
+	/*!
+	 * One entry per connection in the pool, in the order given to the scheduler. Useful for
+	 * injecting errors or responses in a transport workflow via the async_(read|write)_some functions.
+	 */
+	std::vector< ::testing::NiceMock<mock::sss::socket>*> sockets;
+
+	/*! Declared before transport, whose timers and strands must be destroyed while it lives. */
+	boost::asio::io_service ios;
+
+	/*! Connected using sockets, will always be able to re-connect in case of a connection drop. */
+	std::unique_ptr<riak::transport::single_serial_socket::scheduler> transport;
+};
+
+//=============================================================================
+		}   // namespace fixture
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,179 @@
+/*!
+ * \file
+ * Measures the throughput of one client against the number of threads running its io_service.
+ * The client fetches keys from a stand-in Riak node on the loopback interface, which answers
+ * every request at once with an empty GET response, through a pool of 16 connections. Each
+ * connection runs on its own strand and takes the pool's lock only to take its next request, so
+ * throughput should grow with the threads until the connections, or the node, are saturated.
+ *
+ * Usage: io_thread_scaling [GETs per run] [largest number of threads]
+ */
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <riak/client.hxx>
+#include <riak/message.hxx>
+#include <riak/transports/single_serial_socket/delivery_provider.hxx>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using boost::asio::ip::tcp;
+using namespace std::placeholders;
+
+/*!
+ * One connection to the stand-in node. Every complete request frame received is answered with
+ * an empty GET response, in order.
+ */
+class session
+      : public std::enable_shared_from_this<session>
+{
+  public:
+    explicit session (boost::asio::io_service& ios)
+      : socket(ios)
+      , buffer_(16 * 1024)
+    {   }
+
+    void start () {
+        socket.async_read_some(boost::asio::buffer(buffer_),
+                std::bind(&session::on_read, shared_from_this(), _1, _2));
+    }
+
+    tcp::socket socket;
+
+  private:
+    std::vector<char> buffer_;
+    std::string pending_;
+    std::string replies_;
+
+    void on_read (const boost::system::error_code& error, std::size_t n) {
+        if (error)
+            return;
+
+        static const std::string empty_response =
+                riak::message::wire_package(riak::message::code::GetResponse, std::string()).release();
+        pending_.append(buffer_.data(), n);
+        std::size_t consumed = 0;
+        while (pending_.size() - consumed >= 4) {
+            const unsigned char* header = reinterpret_cast<const unsigned char*>(pending_.data() + consumed);
+            std::size_t length = 4 + ((header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3]);
+            if (pending_.size() - consumed < length)
+                break;
+            consumed += length;
+            replies_ += empty_response;
+        }
+        pending_.erase(0, consumed);
+
+        if (replies_.empty()) {
+            start();
+        } else {
+            auto self = shared_from_this();
+            auto sent = std::make_shared<std::string>();
+            sent->swap(replies_);
+            boost::asio::async_write(socket, boost::asio::buffer(*sent), [self, sent] (const boost::system::error_code& e, std::size_t) {
+                if (not e)
+                    self->start();
+            });
+        }
+    }
+};
+
+
+void accept_next (tcp::acceptor& acceptor, boost::asio::io_service& ios)
+{
+    auto next = std::make_shared<session>(ios);
+    acceptor.async_accept(next->socket, [&acceptor, &ios, next] (const boost::system::error_code& error) {
+        if (not error) {
+            next->socket.set_option(tcp::no_delay(true));
+            next->start();
+            accept_next(acceptor, ios);
+        }
+    });
+}
+
+
+std::shared_ptr<riak::object> no_sibling_resolution (const riak::siblings&)
+{
+    return std::make_shared<riak::object>();
+}
+
+
+double measure (uint16_t port, std::size_t threads, std::size_t gets)
+{
+    boost::asio::io_service ios;
+    std::unique_ptr<boost::asio::io_service::work> keep_running(new boost::asio::io_service::work(ios));
+    std::unique_ptr<riak::client> store(new riak::client(
+            riak::transport::make_pooled_transport("127.0.0.1", port, ios, 16),
+            &no_sibling_resolution,
+            ios));
+    boost::thread_group runners;
+    for (std::size_t t = 0; t < threads; ++t)
+        runners.create_thread([&ios] () { ios.run(); });
+
+    std::vector<riak::key> keys;
+    for (std::size_t i = 0; i < gets; ++i)
+        keys.push_back(boost::lexical_cast<std::string>(i));
+
+    boost::mutex mutex;
+    boost::condition_variable finished;
+    bool done = false;
+    std::atomic<std::size_t> failures(0);
+    auto began = std::chrono::steady_clock::now();
+    store->get_objects("load", keys,
+            [&failures] (const riak::key&, const std::error_code& error, std::shared_ptr<riak::object>&, riak::value_updater) {
+                if (error)
+                    ++failures;
+            },
+            [&mutex, &finished, &done] () {
+                boost::unique_lock<boost::mutex> serialize(mutex);
+                done = true;
+                finished.notify_all();
+            },
+            256);
+
+    boost::unique_lock<boost::mutex> serialize(mutex);
+    while (not done)
+        finished.wait(serialize);
+    serialize.unlock();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - began);
+
+    keep_running.reset();
+    ios.stop();
+    runners.join_all();
+    store.reset();
+
+    if (failures > 0)
+        std::cerr << failures << " GETs failed." << std::endl;
+    return gets / (elapsed.count() / 1e6);
+}
+
+
+int main (int argc, const char* argv[])
+{
+    std::size_t gets = (argc > 1) ? boost::lexical_cast<std::size_t>(argv[1]) : 200000;
+    std::size_t max_threads = (argc > 2) ? boost::lexical_cast<std::size_t>(argv[2]) : 8;
+
+    // The stand-in node runs on threads of its own, so as not to compete for the client's.
+    boost::asio::io_service server_ios;
+    tcp::acceptor acceptor(server_ios, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    accept_next(acceptor, server_ios);
+    boost::thread_group server_threads;
+    for (int t = 0; t < 4; ++t)
+        server_threads.create_thread([&server_ios] () { server_ios.run(); });
+
+    std::cout << "threads\tGETs per second" << std::endl;
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2)
+        std::cout << threads << "\t" << measure(acceptor.local_endpoint().port(), threads, gets) << std::endl;
+
+    server_ios.stop();
+    server_threads.join_all();
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <boost/lexical_cast.hpp>
 #include <cstdatomic>
 #include <functional>
+#include <vector>
 #include <riak/client.hxx>
 #include <riak/transports/single_serial_socket.hxx>
 #include <test/tools/use-case-control.hxx>
@@ -79,13 +80,13 @@ int main (int argc, const char* argv[])
 		max_outstanding_queries = 2000;
 
     announce_with_pause("Ready to begin load test...");
-    for (std::size_t query = 0; query < max_outstanding_queries; ++query) {
-    	// std::cout << "sending!" << std::endl;
-    	if (argc > 2)
-	        my_store->get_object("test", lexical_cast<std::string>(query % 1000), std::bind(&print_object_value, argv[2], _1, _2, _3));
-	    else
-	        my_store->get_object("test", lexical_cast<std::string>(query % 1000), std::bind(&print_object_value, "Some sense!", _1, _2, _3));
-    }
+    std::vector<std::string> keys;
+    for (std::size_t query = 0; query < max_outstanding_queries; ++query)
+        keys.push_back(lexical_cast<std::string>(query % 1000));
+    std::string new_value = (argc > 2) ? argv[2] : "Some sense!";
+    my_store->get_objects("test", keys, std::bind(&print_object_value, new_value, _2, _3, _4), [] () {
+        std::cout << "All keys fetched." << std::endl;
+    }, max_outstanding_queries);
     
     ios.run();
     return 0;
@@ -0,0 +1,101 @@
+/*!
+ * \file
+ * Measures how quickly 1 to 32 threads can deliver requests to one socket pool at the same time.
+ * The pool's sockets never connect, so only the submission path is exercised: every request is
+ * taken into the pool's queue by one thread running the io_service, and stays there.
+ *
+ * Usage: submission_contention [requests per thread]
+ */
+#include <boost/asio/io_service.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+#include <riak/transports/single_serial_socket/resolver.hxx>
+#include <riak/transports/single_serial_socket/scheduler.hxx>
+#include <riak/transports/single_serial_socket/socket.hxx>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace sss = riak::transport::single_serial_socket;
+
+/*! Never answers, so that no socket of the pool ever connects. */
+class silent_resolver
+      : public sss::resolver
+{
+  public:
+    void async_resolve (const query&, ResolveHandler) {   }
+};
+
+/*! Never used, as it is never connected. */
+class idle_socket
+      : public sss::socket
+{
+  public:
+    void cancel () {   }
+    void close () {   }
+    void shutdown (boost::asio::ip::tcp::socket::shutdown_type) {   }
+    void async_read_some (const boost::asio::mutable_buffer&, ReadHandler) {   }
+    void async_write_some (const boost::asio::const_buffer&, WriteHandler) {   }
+    void async_connect (const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, ConnectHandler) {   }
+};
+
+
+void submit (
+        sss::scheduler& pool,
+        boost::barrier& start,
+        std::size_t requests,
+        std::vector<riak::transport::option_to_terminate_request>& options)
+{
+    // Terminating a request takes the pool's lock; the options are kept, so that it is not measured.
+    options.reserve(requests);
+    auto ignore_response = [] (std::error_code, std::size_t, const char*) {   };
+    start.wait();
+    for (std::size_t i = 0; i < requests; ++i)
+        options.push_back(pool.deliver("request", ignore_response));
+}
+
+
+double measure (std::size_t threads, std::size_t requests_per_thread)
+{
+    boost::asio::io_service ios;
+    std::unique_ptr<boost::asio::io_service::work> keep_running(new boost::asio::io_service::work(ios));
+    std::vector<std::unique_ptr<sss::socket>> sockets;
+    for (int i = 0; i < 4; ++i)
+        sockets.push_back(std::unique_ptr<sss::socket>(new idle_socket));
+    std::unique_ptr<sss::scheduler> pool(new sss::scheduler(
+            "localhost", 8087, ios, std::move(sockets), std::make_shared<silent_resolver>()));
+    boost::thread io_thread([&ios] () { ios.run(); });
+
+    boost::barrier start(threads + 1);
+    std::vector<std::vector<riak::transport::option_to_terminate_request>> options(threads);
+    boost::thread_group submitters;
+    for (std::size_t t = 0; t < threads; ++t)
+        submitters.create_thread(std::bind(&submit, std::ref(*pool), std::ref(start), requests_per_thread, std::ref(options[t])));
+
+    start.wait();
+    auto began = std::chrono::steady_clock::now();
+    submitters.join_all();
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - began);
+
+    // The options refer to the pool, so they must go first.
+    keep_running.reset();
+    ios.stop();
+    io_thread.join();
+    options.clear();
+    pool.reset();
+
+    return (threads * requests_per_thread) / (elapsed.count() + 1.0);
+}
+
+
+int main (int argc, const char* argv[])
+{
+    std::size_t requests_per_thread = (argc > 1) ? boost::lexical_cast<std::size_t>(argv[1]) : 100000;
+
+    std::cout << "threads\tmillion requests per second" << std::endl;
+    for (std::size_t threads = 1; threads <= 32; threads *= 2)
+        std::cout << threads << "\t" << measure(threads, requests_per_thread) << std::endl;
+    return 0;
+}
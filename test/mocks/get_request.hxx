@@ -19,6 +19,22 @@ class get_request
         		std::shared_ptr< ::riak::object>&,
                 value_updater));
     };
+
+    class keyed_response_handler
+    {
+      public:
+        MOCK_METHOD4(execute, void(
+                const ::riak::key&,
+                const std::error_code&,
+                std::shared_ptr< ::riak::object>&,
+                value_updater));
+    };
+
+    class batch_completion_handler
+    {
+      public:
+        MOCK_METHOD0(execute, void());
+    };
 };
 
 //=============================================================================
@@ -16,6 +16,12 @@ class put_request
       public:
         MOCK_METHOD1(execute, void(const std::error_code&));
     };
+
+    class keyed_response_handler
+    {
+      public:
+        MOCK_METHOD2(execute, void(const ::riak::key&, const std::error_code&));
+    };
 };
 
 //=============================================================================
@@ -30,6 +30,11 @@ class device::response_handler
 {
   public:
 	MOCK_METHOD3(execute, void(const std::error_code&, std::size_t, std::string));
+
+	/*! In the shape of ::riak::transport::response_handler; copies the bytes for inspection. */
+	void receive (const std::error_code& error, std::size_t n, const char* data) {
+		execute(error, n, std::string(data, n));
+	}
 };
 
 //=============================================================================
@@ -16,7 +16,7 @@ class resolver
   	resolver ();
   	virtual ~resolver ();
 
-  	MOCK_METHOD1(resolve, iterator(const query&));
+  	MOCK_METHOD2(async_resolve, void(const query&, ResolveHandler));
 };
 
 //=============================================================================
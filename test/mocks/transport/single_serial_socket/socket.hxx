@@ -19,9 +19,9 @@ class socket
 	MOCK_METHOD0(cancel, void());
 	MOCK_METHOD0(close, void());
 	MOCK_METHOD1(shutdown, void(boost::asio::ip::tcp::socket::shutdown_type));
-	MOCK_METHOD2(async_read_some, void(boost::asio::streambuf&, ReadHandler));
+	MOCK_METHOD2(async_read_some, void(const boost::asio::mutable_buffer&, ReadHandler));
 	MOCK_METHOD2(async_write_some, void(const boost::asio::const_buffer&, WriteHandler));
-	MOCK_METHOD2(connect, boost::system::error_code(const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, boost::system::error_code&));
+	MOCK_METHOD2(async_connect, void(const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, ConnectHandler));
 };
 
 //=============================================================================
@@ -0,0 +1,90 @@
+/*!
+ * \file
+ * Implements unit tests for the routing of requests among the nodes of a cluster.
+ */
+#include <gtest/gtest.h>
+#include <test/fixtures/cluster_transport/two_node_cluster.hxx>
+#include <riak/message.hxx>
+#include <system_error>
+
+using namespace ::testing;
+using riak::test::fixture::two_node_cluster;
+
+//=============================================================================
+namespace riak {
+	namespace test {
+//=============================================================================
+
+TEST_F(two_node_cluster, requests_go_to_the_node_with_fewest_outstanding)
+{
+	EXPECT_CALL(devices[0], deliver(_, _)).Times(2);
+	EXPECT_CALL(devices[1], deliver(_, _)).Times(1);
+
+	auto t1 = send();
+	auto t2 = send();
+	EXPECT_EQ(1u, cluster->outstanding_requests(0));
+	EXPECT_EQ(1u, cluster->outstanding_requests(1));
+
+	t1(false);
+	t1(false);
+	EXPECT_EQ(0u, cluster->outstanding_requests(0));
+	auto t3 = send();
+	EXPECT_EQ(1u, cluster->outstanding_requests(0));
+}
+
+
+TEST_F(two_node_cluster, node_failing_requests_is_avoided)
+{
+	EXPECT_CALL(devices[0], deliver(_, _)).Times(1);
+	EXPECT_CALL(devices[1], deliver(_, _)).Times(3);
+
+	auto t1 = send();
+	deliveries[0][0](std::make_error_code(std::errc::connection_refused), 0, "");
+	t1(true);
+	auto t2 = send();
+	deliveries[1][0](std::error_code(), 5, "reply");
+	t2(false);
+
+	// The failed node now seems slow, enough to outweigh a request waiting on the other.
+	auto t3 = send();
+	auto t4 = send();
+	EXPECT_EQ(0u, cluster->outstanding_requests(0));
+	EXPECT_EQ(2u, cluster->outstanding_requests(1));
+}
+
+
+
+TEST_F(two_node_cluster, node_failing_repeatedly_is_ejected_until_a_probe_succeeds)
+{
+	EXPECT_CALL(devices[0], deliver(_, _)).Times(2);
+	EXPECT_CALL(devices[1], deliver(_, _)).Times(3);
+
+	// Both requests to the first node are abandoned unanswered, as upon a timeout.
+	auto t1 = send();
+	auto t2 = send();
+	auto t3 = send();
+	t1(true);
+	EXPECT_FALSE(cluster->is_ejected(0));
+	t3(true);
+	EXPECT_TRUE(cluster->is_ejected(0));
+
+	// The other node now takes everything, even with a request outstanding.
+	auto t4 = send();
+	auto t5 = send();
+	EXPECT_EQ(3u, cluster->outstanding_requests(1));
+	Mock::VerifyAndClearExpectations(&devices[0]);
+
+	// Once the node answers a ping, it is readmitted.
+	const std::string ping = message::wire_package(message::code::PingRequest, std::string()).to_string();
+	const std::string pong = message::wire_package(message::code::PingResponse, std::string()).to_string();
+	EXPECT_CALL(devices[0], deliver(ping, _));
+	ios.run_one();
+	ASSERT_EQ(3u, deliveries[0].size());
+	deliveries[0].back()(std::error_code(), pong.size(), pong.data());
+	EXPECT_FALSE(cluster->is_ejected(0));
+}
+
+//=============================================================================
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -24,7 +24,7 @@ namespace riak {
 
 TEST_F(deleting_client, client_receives_socket_errors)
 {
-    client.delete_object("x", "y", response_handler);
+    client->delete_object("x", "y", response_handler);
 
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(std::make_error_code(std::errc::connection_reset))));
@@ -36,13 +36,13 @@ TEST_F(deleting_client, client_receives_socket_errors)
 #   endif
 
     std::string garbage("uhetnaoutaenosueosaueoas");
-    send_from_server(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage);
+    send_from_server(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage.data());
 }
 
 
 TEST_F(deleting_client, client_survives_nonsense_reply_to_unmap)
 {
-    client.delete_object("a", "document", response_handler);
+    client->delete_object("a", "document", response_handler);
 
     // Expect no calls, as this particular garbage suggests a longer reply; the request
     // would eventually time out.
@@ -50,13 +50,13 @@ TEST_F(deleting_client, client_survives_nonsense_reply_to_unmap)
     EXPECT_CALL(response_handler_mock, execute(_)).Times(0);
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
     std::string garbage("uhetnaoutaenosueosaueoas");
-    send_from_server(std::error_code(), garbage.size(), garbage);
+    send_from_server(std::error_code(), garbage.size(), garbage.data());
 }
 
 
 TEST_F(deleting_client, client_survives_wrong_code_reply_to_unmap)
 {
-    client.delete_object("a", "document", response_handler);
+    client->delete_object("a", "document", response_handler);
 
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code(communication_failure::unparseable_response))));
@@ -69,31 +69,31 @@ TEST_F(deleting_client, client_survives_wrong_code_reply_to_unmap)
 #   endif
 
     riak::message::wire_package bad_reply(riak::message::code::GetResponse, "whatever");
-    send_from_server(std::error_code(), bad_reply.to_string().size(), bad_reply.to_string());
+    send_from_server(std::error_code(), bad_reply.to_string().size(), bad_reply.to_string().data());
 }
 
 
 TEST_F(deleting_client, client_survives_trailing_data_with_RpbDelResp)
 {
-    client.delete_object("a", "document", response_handler);
+    client->delete_object("a", "document", response_handler);
 
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code())));
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
     riak::message::wire_package long_reply(riak::message::code::DeleteResponse, "atnhueoauheas(garbage)");
-    send_from_server(std::error_code(), long_reply.to_string().size(), long_reply.to_string());
+    send_from_server(std::error_code(), long_reply.to_string().size(), long_reply.to_string().data());
 }
 
 
 TEST_F(deleting_client, client_accepts_well_formed_RbpDelResp)
 {
-    client.delete_object("a", "document", response_handler);
+    client->delete_object("a", "document", response_handler);
     
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code())));
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
     riak::message::wire_package clean_reply(riak::message::code::DeleteResponse, "");
-    send_from_server(std::error_code(), clean_reply.to_string().size(), clean_reply.to_string());
+    send_from_server(std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
 
 }
 
@@ -101,7 +101,7 @@ TEST_F(deleting_client, client_accepts_well_formed_RbpDelResp)
 TEST_F(deleting_client, client_accepts_well_formed_unmap_response_in_parts)
 {
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
-    client.delete_object("a", "document", response_handler);
+    client->delete_object("a", "document", response_handler);
     
     std::string response_data;
     std::string canned_delete_response = "";   // Deletes are only message code responses.
@@ -114,12 +114,12 @@ TEST_F(deleting_client, client_accepts_well_formed_unmap_response_in_parts)
     // The first half should be correctly buffered.
     EXPECT_CALL(closure_signal, exercise()).Times(0);
     EXPECT_CALL(response_handler_mock, execute(_)).Times(0);
-    send_from_server(std::error_code(), first_half.size(), first_half);
+    send_from_server(std::error_code(), first_half.size(), first_half.data());
 
     // The second half should trigger a response callback.
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code())));
-    send_from_server(std::error_code(), second_half.size(), second_half);
+    send_from_server(std::error_code(), second_half.size(), second_half.data());
 }
 
 //=============================================================================
@@ -0,0 +1,118 @@
+/*!
+ * \file
+ * Implements unit tests for the storage of values which were not first fetched from the server.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <test/mocks/get_request.hxx>
+#include <test/mocks/put_request.hxx>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+        namespace {
+//=============================================================================
+
+std::shared_ptr<object> object_with_value (const std::string& value)
+{
+    auto result = std::make_shared<object>();
+    result->set_value(value);
+    return result;
+}
+
+
+RpbPutReq sent_put_request (const std::string& wire_data)
+{
+    RpbPutReq request;
+    EXPECT_TRUE(message::retrieve(request, wire_data.size(), wire_data));
+    return request;
+}
+
+
+std::string as_reply (const RpbPutResp& response)
+{
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    return message::wire_package(message::code::PutResponse, response_data).to_string();
+}
+
+//=============================================================================
+        }   // namespace (anonymous)
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+
+TEST_F(riak_client_with_mocked_transport, put_returning_body_yields_an_updater_holding_the_new_vclock)
+{
+    EXPECT_CALL(transport, deliver(_, _)).Times(2);
+    client->put_object("a", "document", object_with_value("first"), boost::none, put_returns::body, response_handler);
+    ASSERT_EQ(1u, requests.size());
+    RpbPutReq first_put = sent_put_request(requests[0]);
+    EXPECT_TRUE(first_put.return_body());
+    EXPECT_FALSE(first_put.has_vclock());
+
+    RpbPutResp stored;
+    stored.set_vclock("v2");
+    stored.add_content()->set_value("first");
+    std::shared_ptr<object> returned_object;
+    value_updater update_value;
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), _, _))
+        .WillOnce(DoAll(SaveArg<1>(&returned_object), SaveArg<2>(&update_value)));
+    const std::string reply = as_reply(stored);
+    deliveries[0](std::error_code(), reply.size(), reply.data());
+    ASSERT_TRUE(!! returned_object);
+    EXPECT_EQ("first", returned_object->value());
+
+    // The next write follows from the first without a GET in between.
+    ASSERT_TRUE(!! update_value);
+    update_value(object_with_value("second"), [] (const std::error_code&) {});
+    ASSERT_EQ(2u, requests.size());
+    RpbPutReq second_put = sent_put_request(requests[1]);
+    EXPECT_EQ("v2", second_put.vclock());
+    EXPECT_EQ("second", second_put.content().value());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, batched_puts_store_every_value_without_a_vclock)
+{
+    mock::put_request::keyed_response_handler each_mock;
+    mock::get_request::batch_completion_handler done_mock;
+    std::vector<std::pair<key, std::shared_ptr<object>>> values;
+    values.push_back(std::make_pair("a", object_with_value("1")));
+    values.push_back(std::make_pair("b", object_with_value("2")));
+
+    client->put_objects("bucket", values,
+            std::bind(&mock::put_request::keyed_response_handler::execute, &each_mock, _1, _2),
+            std::bind(&mock::get_request::batch_completion_handler::execute, &done_mock),
+            /* concurrency */ 1);
+    ASSERT_EQ(1u, requests.size());
+
+    const std::string reply = as_reply(RpbPutResp());
+    EXPECT_CALL(each_mock, execute(Eq("a"), Eq(riak::make_error_code())));
+    deliveries[0](std::error_code(), reply.size(), reply.data());
+    ASSERT_EQ(2u, requests.size());
+
+    EXPECT_CALL(each_mock, execute(Eq("b"), Eq(riak::make_error_code())));
+    EXPECT_CALL(done_mock, execute());
+    deliveries[1](std::error_code(), reply.size(), reply.data());
+
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        RpbPutReq put = sent_put_request(requests[i]);
+        EXPECT_EQ("bucket", put.bucket());
+        EXPECT_EQ(values[i].first, put.key());
+        EXPECT_FALSE(put.has_vclock());
+    }
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
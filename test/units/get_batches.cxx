@@ -0,0 +1,111 @@
+/*!
+ * \file
+ * Implements unit tests for the fetching of many objects through one call to the client.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <test/mocks/get_request.hxx>
+#include <system_error>
+#include <vector>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+using std::placeholders::_4;
+
+TEST_F(riak_client_with_mocked_transport, batched_gets_are_bounded_and_each_key_is_answered)
+{
+    mock::get_request::keyed_response_handler each_mock;
+    mock::get_request::batch_completion_handler done_mock;
+    keyed_get_response_handler each = std::bind(&mock::get_request::keyed_response_handler::execute, &each_mock, _1, _2, _3, _4);
+    batch_completion_handler done = std::bind(&mock::get_request::batch_completion_handler::execute, &done_mock);
+
+    std::string response_data;
+    RpbGetResp().SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+    auto answer = [&] (std::size_t delivery) {
+        deliveries[delivery](std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
+    };
+
+    std::vector<key> keys;
+    keys.push_back("a");
+    keys.push_back("b");
+    keys.push_back("c");
+    client->get_objects("bucket", keys, each, done, /* concurrency */ 2);
+    EXPECT_EQ(2u, deliveries.size());
+
+    // Each answer makes room for one more GET; the batch completes only with the last.
+    EXPECT_CALL(done_mock, execute()).Times(0);
+    EXPECT_CALL(each_mock, execute(Eq("b"), Eq(riak::make_error_code()), _, _));
+    answer(1);
+    ASSERT_EQ(3u, deliveries.size());
+
+    EXPECT_CALL(each_mock, execute(Eq("c"), Eq(riak::make_error_code()), _, _));
+    answer(2);
+    Mock::VerifyAndClearExpectations(&done_mock);
+
+    EXPECT_CALL(each_mock, execute(Eq("a"), Eq(riak::make_error_code()), _, _));
+    EXPECT_CALL(done_mock, execute());
+    answer(0);
+    EXPECT_EQ(3u, deliveries.size());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, key_which_cannot_be_sent_is_answered_and_the_batch_completes)
+{
+    mock::get_request::keyed_response_handler each_mock;
+    mock::get_request::batch_completion_handler done_mock;
+    keyed_get_response_handler each = std::bind(&mock::get_request::keyed_response_handler::execute, &each_mock, _1, _2, _3, _4);
+    batch_completion_handler done = std::bind(&mock::get_request::batch_completion_handler::execute, &done_mock);
+
+    std::string response_data;
+    RpbGetResp().SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+
+    // The transport halts after taking the first key.
+    EXPECT_CALL(transport, deliver(_, _))
+        .WillOnce(DoDefault())
+        .WillOnce(Throw(std::system_error(std::make_error_code(std::errc::network_down))));
+
+    std::vector<key> keys;
+    keys.push_back("a");
+    keys.push_back("b");
+    client->get_objects("bucket", keys, each, done, /* concurrency */ 2);
+    ASSERT_EQ(1u, deliveries.size());
+
+    EXPECT_CALL(each_mock, execute(Eq("b"), Eq(std::make_error_code(std::errc::network_down)), _, _));
+    EXPECT_CALL(done_mock, execute()).Times(0);
+    ios.poll();
+    Mock::VerifyAndClearExpectations(&done_mock);
+
+    EXPECT_CALL(each_mock, execute(Eq("a"), Eq(riak::make_error_code()), _, _));
+    EXPECT_CALL(done_mock, execute());
+    deliveries[0](std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, empty_batch_completes_at_once)
+{
+    mock::get_request::keyed_response_handler each_mock;
+    mock::get_request::batch_completion_handler done_mock;
+    EXPECT_CALL(transport, deliver(_, _)).Times(0);
+    EXPECT_CALL(done_mock, execute());
+
+    client->get_objects("bucket", std::vector<key>(),
+            std::bind(&mock::get_request::keyed_response_handler::execute, &each_mock, _1, _2, _3, _4),
+            std::bind(&mock::get_request::batch_completion_handler::execute, &done_mock));
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
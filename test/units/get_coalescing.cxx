@@ -0,0 +1,90 @@
+/*!
+ * \file
+ * Implements unit tests for the sharing of one GET among concurrent requests for the same key.
+ */
+#include <gtest/gtest.h>
+#include <riak/get_coalescer.hxx>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <test/mocks/get_request.hxx>
+#include <system_error>
+#include <vector>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+TEST_F(riak_client_with_mocked_transport, concurrent_gets_of_one_key_share_a_request_but_not_an_object)
+{
+    get_coalescer coalesce(*client);
+    mock::get_request::response_handler first_mock, second_mock, other_key_mock;
+    coalesce.get_object("bucket", "hot", std::bind(&mock::get_request::response_handler::execute, &first_mock, _1, _2, _3));
+    coalesce.get_object("bucket", "hot", std::bind(&mock::get_request::response_handler::execute, &second_mock, _1, _2, _3));
+    coalesce.get_object("bucket", "cold", std::bind(&mock::get_request::response_handler::execute, &other_key_mock, _1, _2, _3));
+    ASSERT_EQ(2u, deliveries.size());
+    EXPECT_EQ(2u, coalesce.keys_in_flight());
+
+    RpbGetResp response;
+    response.set_vclock("clock");
+    response.add_content()->set_value("value");
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    message::wire_package reply(message::code::GetResponse, response_data);
+
+    std::shared_ptr<object> first_value, second_value;
+    value_updater first_updater, second_updater;
+    EXPECT_CALL(first_mock, execute(Eq(riak::make_error_code()), _, _))
+        .WillOnce(DoAll(SaveArg<1>(&first_value), SaveArg<2>(&first_updater)));
+    EXPECT_CALL(second_mock, execute(Eq(riak::make_error_code()), _, _))
+        .WillOnce(DoAll(SaveArg<1>(&second_value), SaveArg<2>(&second_updater)));
+    EXPECT_CALL(other_key_mock, execute(_, _, _)).Times(0);
+    deliveries[0](std::error_code(), reply.to_string().size(), reply.to_string().data());
+
+    ASSERT_TRUE(first_value and second_value);
+    EXPECT_NE(first_value, second_value);
+    EXPECT_EQ("value", first_value->value());
+    EXPECT_EQ("value", second_value->value());
+    EXPECT_EQ(1u, coalesce.keys_in_flight());
+
+    // Both may write back, each under the vector clock received.
+    second_updater(second_value, [] (const std::error_code&) {   });
+    ASSERT_EQ(3u, requests.size());
+    RpbPutReq put;
+    ASSERT_TRUE(message::retrieve(put, requests[2].size(), requests[2]));
+    EXPECT_EQ("clock", put.vclock());
+    EXPECT_TRUE(!! first_updater);
+}
+
+
+TEST_F(riak_client_with_mocked_transport, get_which_could_not_be_sent_is_forgotten)
+{
+    get_coalescer coalesce(*client);
+    EXPECT_CALL(transport, deliver(_, _))
+        .WillOnce(Throw(std::system_error(std::make_error_code(std::errc::network_down))));
+    mock::get_request::response_handler failed_mock;
+    EXPECT_CALL(failed_mock, execute(_, _, _)).Times(0);
+    EXPECT_THROW(
+            coalesce.get_object("bucket", "key", std::bind(&mock::get_request::response_handler::execute, &failed_mock, _1, _2, _3)),
+            std::system_error);
+    EXPECT_EQ(0u, coalesce.keys_in_flight());
+
+    // The next GET of the key is sent, rather than left waiting on the one which never was.
+    Mock::VerifyAndClearExpectations(&transport);
+    mock::get_request::response_handler next_mock;
+    coalesce.get_object("bucket", "key", std::bind(&mock::get_request::response_handler::execute, &next_mock, _1, _2, _3));
+    EXPECT_EQ(1u, deliveries.size());
+    EXPECT_EQ(1u, coalesce.keys_in_flight());
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -7,6 +7,7 @@
 #include <gtest/gtest.h>
 #include <riak/message.hxx>
 #include <test/fixtures/getting_client.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
 #include <system_error>
 
 #if RIAK_CPP_LOGGING_ENABLED
@@ -16,17 +17,21 @@
 
 using namespace ::testing;
 using riak::test::fixture::getting_client;
+using riak::test::fixture::riak_client_with_mocked_transport;
 
 //=============================================================================
 namespace riak {
     namespace test {
 //=============================================================================
 
+using std::placeholders::_1;
+using std::placeholders::_2;
+
 RpbGetResp empty_get_response;
 
 TEST_F(getting_client, client_receives_socket_errors)
 {
-    client.get_object("x", "y", response_handler);
+    client->get_object("x", "y", response_handler);
 
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(Eq(std::make_error_code(std::errc::connection_reset)), _, _));
@@ -38,13 +43,13 @@ TEST_F(getting_client, client_receives_socket_errors)
 #   endif
 
     std::string garbage("uhetnaoutaenosueosaueoas");
-    send_from_server(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage);
+    send_from_server(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage.data());
 }
 
 
 TEST_F(getting_client, client_survives_long_nonsense_reply_to_get)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
     
     // Expect no calls, as this particular garbage suggests a longer reply; the request
     // would eventually time out.
@@ -52,13 +57,13 @@ TEST_F(getting_client, client_survives_long_nonsense_reply_to_get)
     EXPECT_CALL(response_handler_mock, execute(_, _, _)).Times(0);
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
     std::string garbage("uhetnaoutaenosueosaueoas");
-    send_from_server(std::error_code(), garbage.size(), garbage);
+    send_from_server(std::error_code(), garbage.size(), garbage.data());
 }
 
 
 TEST_F(getting_client, client_survives_wrong_code_reply_to_get)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
 
     RpbGetResp nonempty_get_response;
     nonempty_get_response.add_content()->set_value("Son of a gun!");
@@ -80,13 +85,13 @@ TEST_F(getting_client, client_survives_wrong_code_reply_to_get)
         EXPECT_CALL(log_sinks, consume(LogRecordAttributeSet(HasAttribute<severity>("Severity", Eq(severity::error)))));    
 #   endif
 
-    send_from_server(std::error_code(), bad_reply.to_string().size(), bad_reply.to_string());
+    send_from_server(std::error_code(), bad_reply.to_string().size(), bad_reply.to_string().data());
 }
 
 
 TEST_F(getting_client, client_survives_extra_data_in_empty_get_response)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
 
     std::string response_with_extra;
     empty_get_response.SerializeToString(&response_with_extra);
@@ -99,13 +104,13 @@ TEST_F(getting_client, client_survives_extra_data_in_empty_get_response)
             IsNull(),
             _));
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
-    send_from_server(std::error_code(), long_reply.size(), long_reply);
+    send_from_server(std::error_code(), long_reply.size(), long_reply.data());
 }
 
 
 TEST_F(getting_client, client_accepts_nonempty_get_response)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
 
     RpbGetResp nonempty_get_response;
     nonempty_get_response.add_content()->set_value("Son of a gun!");
@@ -120,13 +125,13 @@ TEST_F(getting_client, client_accepts_nonempty_get_response)
             Pointee(Property(&riak::object::value, StrEq(nonempty_get_response.content(0).value()))),
             _));
     EXPECT_CALL(sibling_resolution, evaluate(_)).Times(0);
-    send_from_server(std::error_code(), nonempty_reply.to_string().size(), nonempty_reply.to_string());
+    send_from_server(std::error_code(), nonempty_reply.to_string().size(), nonempty_reply.to_string().data());
 }
 
 
 TEST_F(getting_client, client_accepts_empty_RbpGetResp)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
     
     EXPECT_CALL(closure_signal, exercise());
     EXPECT_CALL(response_handler_mock, execute(
@@ -137,13 +142,13 @@ TEST_F(getting_client, client_accepts_empty_RbpGetResp)
     std::string response_data;
     empty_get_response.SerializeToString(&response_data);
     riak::message::wire_package clean_reply(riak::message::code::GetResponse, response_data);
-    send_from_server(std::error_code(), clean_reply.to_string().size(), clean_reply.to_string());
+    send_from_server(std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
 }
 
 
 TEST_F(getting_client, client_accepts_well_formed_response_in_parts)
 {
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
     
     RpbGetResp nonempty_get_response;
     nonempty_get_response.add_content()->set_value("Son of a gun!");
@@ -159,7 +164,7 @@ TEST_F(getting_client, client_accepts_well_formed_response_in_parts)
     // The first half should be correctly buffered.
     EXPECT_CALL(closure_signal, exercise()).Times(0);
     EXPECT_CALL(response_handler_mock, execute(_, _, _)).Times(0);
-    send_from_server(std::error_code(), first_half.size(), first_half);
+    send_from_server(std::error_code(), first_half.size(), first_half.data());
 
     // The second half should trigger a response callback.
     EXPECT_CALL(closure_signal, exercise());
@@ -167,7 +172,7 @@ TEST_F(getting_client, client_accepts_well_formed_response_in_parts)
             Eq(riak::make_error_code()),
             Pointee(Property(&riak::object::value, StrEq(nonempty_get_response.content(0).value()))),
             _));
-    send_from_server(std::error_code(), second_half.size(), second_half);
+    send_from_server(std::error_code(), second_half.size(), second_half.data());
 }
 
 
@@ -185,7 +190,7 @@ TEST_F(getting_client, client_returns_single_object_with_no_vector_clock)
     riak::message::wire_package clean_reply(riak::message::code::GetResponse, response_data);
     auto data = clean_reply.to_string();
 
-    client.get_object("a", "document", response_handler);
+    client->get_object("a", "document", response_handler);
 
     // This response should trigger a response callback with no error.
     EXPECT_CALL(closure_signal, exercise());
@@ -203,7 +208,62 @@ TEST_F(getting_client, client_returns_single_object_with_no_vector_clock)
                     LogRecordAttributeSet(HasAttribute<std::string>("Message", MatchesRegex(".*siblings?.*"))))));
 #   endif
 
-    send_from_server(std::error_code(), data.size(), data);
+    send_from_server(std::error_code(), data.size(), data.data());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, transport_may_answer_before_returning_from_delivery)
+{
+    std::string response_data;
+    empty_get_response.SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+    auto data = clean_reply.to_string();
+
+    // The response is heard only once the option to terminate the request is held, so that it
+    // can be exercised.
+    typedef mock::transport::device::option_to_terminate_request mock_close_option;
+    auto answer_at_once = [&] (const std::string&, ::riak::transport::response_handler h) {
+        h(std::error_code(), data.size(), data.data());
+        return ::riak::transport::option_to_terminate_request(std::bind(&mock_close_option::exercise, &closure_signal));
+    };
+    EXPECT_CALL(transport, deliver(_, _)).WillOnce(Invoke(answer_at_once));
+    EXPECT_CALL(closure_signal, exercise());
+
+    std::size_t responses = 0;
+    client->get_object("a", "document", [&] (const std::error_code& error, std::shared_ptr<object>&, value_updater) {
+        EXPECT_FALSE(error);
+        ++responses;
+    });
+    EXPECT_EQ(1u, responses);
+}
+
+
+TEST_F(riak_client_with_mocked_transport, requests_and_their_updates_are_delivered_in_the_class_of_their_call)
+{
+    auto wrong_class = [] (std::string, ::riak::transport::response_handler) {
+        ADD_FAILURE() << "A request was delivered in the wrong priority class.";
+        return ::riak::transport::option_to_terminate_request([] (bool) {   });
+    };
+    std::vector< ::riak::transport::delivery_provider> per_class;
+    per_class.push_back(wrong_class);
+    per_class.push_back(std::bind(&mock::transport::device::deliver, &transport, _1, _2));
+    riak::client prioritized(std::move(per_class), [] (const siblings&) { return std::shared_ptr<object>(); }, ios,
+            client::failure_defaults.with_retries_permitted(0));
+
+    value_updater update;
+    prioritized.get_object("a", "document", [&] (const std::error_code&, std::shared_ptr<object>&, value_updater u) {
+        update = u;
+    }, 1);
+    ASSERT_EQ(1u, deliveries.size());
+
+    std::string response_data;
+    empty_get_response.SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+    deliveries[0](std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
+
+    ASSERT_TRUE(!! update);
+    update(std::make_shared<object>(), [] (const std::error_code&) {   });
+    EXPECT_EQ(2u, deliveries.size());
 }
 
 //=============================================================================
@@ -0,0 +1,56 @@
+/*!
+ * \file
+ * Implements unit tests for fetching the metadata of objects without their values.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <system_error>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+//=============================================================================
+
+TEST_F(riak_client_with_mocked_transport, head_yields_the_metadata_of_every_sibling_without_resolving_them)
+{
+    std::error_code error = make_error_code(communication_failure::unparseable_response);
+    object_head head;
+    client->head_object("bucket", "key", [&] (const std::error_code& e, const object_head& h) {
+        error = e;
+        head = h;
+    });
+
+    ASSERT_EQ(1u, requests.size());
+    RpbGetReq request;
+    ASSERT_TRUE(message::retrieve(request, requests[0].size(), requests[0]));
+    EXPECT_TRUE(request.head());
+
+    RpbGetResp response;
+    response.set_vclock("clock");
+    auto first = response.add_content();
+    first->set_value("");
+    first->set_content_type("application/json");
+    first->add_usermeta()->set_key("owner");
+    response.add_content()->set_value("");
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    message::wire_package reply(message::code::GetResponse, response_data);
+    deliveries[0](std::error_code(), reply.to_string().size(), reply.to_string().data());
+
+    EXPECT_FALSE(error);
+    ASSERT_TRUE(!! head.vclock);
+    EXPECT_EQ("clock", *head.vclock);
+    ASSERT_EQ(2u, head.siblings.size());
+    EXPECT_EQ("application/json", head.siblings[0]->content_type());
+    ASSERT_EQ(1, head.siblings[0]->usermeta_size());
+    EXPECT_EQ("owner", head.siblings[0]->usermeta(0).key());
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,74 @@
+/*!
+ * \file
+ * Implements unit tests for the listing of keys, which the server streams over several responses.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <system_error>
+#include <vector>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+        namespace {
+//=============================================================================
+
+std::string key_listing_reply (const std::vector<key>& keys, bool done)
+{
+    RpbListKeysResp response;
+    for (auto k = keys.begin(); k != keys.end(); ++k)
+        response.add_keys(*k);
+    if (done)
+        response.set_done(true);
+
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    return message::wire_package(message::code::ListKeysResponse, response_data).to_string();
+}
+
+//=============================================================================
+        }   // namespace (anonymous)
+//=============================================================================
+
+TEST_F(riak_client_with_mocked_transport, listed_keys_are_delivered_batch_by_batch_until_done)
+{
+    std::vector<key> received;
+    std::vector<std::error_code> completions;
+    auto on_keys = [&received] (const ::google::protobuf::RepeatedPtrField<key>& keys) {
+        received.insert(received.end(), keys.begin(), keys.end());
+    };
+    auto on_done = [&completions] (const std::error_code& e) { completions.push_back(e); };
+
+    EXPECT_CALL(closure_signal, exercise()).Times(1);
+    client->list_keys("bucket", on_keys, on_done);
+    ASSERT_EQ(1u, requests.size());
+    RpbListKeysReq request;
+    ASSERT_TRUE(message::retrieve(request, requests[0].size(), requests[0]));
+    EXPECT_EQ("bucket", request.bucket());
+
+    std::vector<key> first_batch, second_batch;
+    first_batch.push_back("a");
+    first_batch.push_back("b");
+    second_batch.push_back("c");
+    const std::string first = key_listing_reply(first_batch, false);
+    deliveries[0](std::error_code(), first.size(), first.data());
+    EXPECT_EQ(2u, received.size());
+    EXPECT_TRUE(completions.empty());
+
+    // Several responses may arrive in one read; the empty closing response carries no keys.
+    const std::string rest = key_listing_reply(second_batch, false) + key_listing_reply(std::vector<key>(), true);
+    deliveries[0](std::error_code(), rest.size(), rest.data());
+    ASSERT_EQ(3u, received.size());
+    EXPECT_EQ("c", received[2]);
+    ASSERT_EQ(1u, completions.size());
+    EXPECT_EQ(riak::make_error_code(), completions[0]);
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,123 @@
+/*!
+ * \file
+ * Implements unit tests for the wire format of Riak messages: their encoding, and their collection
+ * from streamed network input.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <string>
+#include <system_error>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+    namespace test {
+        namespace {
+//=============================================================================
+
+std::string message_with_body (char code, const std::string& body)
+{
+    std::string result(4, '\0');
+    std::size_t length = body.size() + 1;
+    for (int i = 3; i >= 0; --i, length >>= 8)
+        result[i] = static_cast<char>(length & 0xff);
+    return result + code + body;
+}
+
+/*!
+ * Records every message given to it, and declares the request satisfied after a fixed number.
+ */
+struct message_log
+{
+    explicit message_log (std::size_t messages_expected)
+      : expected(messages_expected)
+    {   }
+
+    bool operator() (std::error_code error, std::size_t size, const char* data) {
+        errors.push_back(error);
+        messages.push_back(std::string(data, size));
+        return messages.size() == expected;
+    }
+
+    std::size_t expected;
+    std::vector<std::error_code> errors;
+    std::vector<std::string> messages;
+};
+
+bool feed (message::buffering_handler& h, const std::string& bytes)
+{
+    return h(std::error_code(), bytes.size(), bytes.data());
+}
+
+//=============================================================================
+        }   // namespace (anonymous)
+//=============================================================================
+
+TEST(message_framing, all_messages_received_at_once_are_delivered)
+{
+    auto log = std::make_shared<message_log>(3);
+    message::handler h = std::bind(&message_log::operator(), log, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+    auto collect = message::make_buffering_handler(h);
+
+    const std::string first = message_with_body(10, "a"), second = message_with_body(10, "bb"), third = message_with_body(10, "");
+    EXPECT_TRUE(feed(collect, first + second + third));
+    ASSERT_EQ(3u, log->messages.size());
+    EXPECT_EQ(first, log->messages[0]);
+    EXPECT_EQ(second, log->messages[1]);
+    EXPECT_EQ(third, log->messages[2]);
+}
+
+
+TEST(message_framing, messages_spanning_reads_are_delivered_whole)
+{
+    auto log = std::make_shared<message_log>(2);
+    message::handler h = std::bind(&message_log::operator(), log, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+    auto collect = message::make_buffering_handler(h);
+
+    const std::string first = message_with_body(10, "cheesy"), second = message_with_body(10, "brains!");
+    const std::string stream = first + second;
+    EXPECT_FALSE(feed(collect, stream.substr(0, 2)));
+    EXPECT_FALSE(feed(collect, stream.substr(2, 12)));
+    EXPECT_EQ(1u, log->messages.size());
+    EXPECT_TRUE(feed(collect, stream.substr(14)));
+
+    ASSERT_EQ(2u, log->messages.size());
+    EXPECT_EQ(first, log->messages[0]);
+    EXPECT_EQ(second, log->messages[1]);
+}
+
+
+TEST(message_framing, nothing_is_delivered_after_the_request_is_satisfied)
+{
+    auto log = std::make_shared<message_log>(1);
+    message::handler h = std::bind(&message_log::operator(), log, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3);
+    auto collect = message::make_buffering_handler(h);
+
+    EXPECT_TRUE(feed(collect, message_with_body(10, "a") + message_with_body(10, "b")));
+    EXPECT_EQ(1u, log->messages.size());
+}
+
+
+TEST(message_framing, encoded_message_is_header_followed_by_serialized_body)
+{
+    RpbPutReq request;
+    request.set_bucket("b");
+    request.set_key("k");
+    request.mutable_content()->set_value(std::string(3000, 'x'));
+    std::string body;
+    request.SerializeToString(&body);
+
+    auto package = message::encode(request);
+    EXPECT_EQ(message_with_body(message::code::PutRequest, body), package.to_string());
+
+    RpbPutReq decoded;
+    std::string wire_data = package.release();
+    EXPECT_TRUE(message::retrieve(decoded, wire_data.size(), wire_data));
+    EXPECT_EQ(request.content().value(), decoded.content().value());
+    EXPECT_TRUE(package.to_string().empty());
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,134 @@
+/*!
+ * \file
+ * Implements unit tests for the revalidation of cached objects by conditional GETs.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <riak/object_cache.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <test/mocks/get_request.hxx>
+#include <system_error>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+TEST_F(riak_client_with_mocked_transport, unchanged_object_is_served_from_the_cache_without_its_value)
+{
+    auto cache = std::make_shared<object_cache>(1024);
+    auto never_resolve = [] (const siblings&) { return std::shared_ptr<object>(); };
+    riak::client cached(std::bind(&mock::transport::device::deliver, &transport, _1, _2), never_resolve, ios,
+            client::failure_defaults, client::access_override_defaults, cache);
+
+    // The first GET misses, and fetches the object whole.
+    cached.get_object("bucket", "key", response_handler);
+    ASSERT_EQ(1u, deliveries.size());
+    RpbGetReq request;
+    ASSERT_TRUE(message::retrieve(request, requests[0].size(), requests[0]));
+    EXPECT_FALSE(request.has_if_modified());
+
+    RpbGetResp response;
+    response.set_vclock("clock");
+    response.add_content()->set_value("value");
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    message::wire_package whole(message::code::GetResponse, response_data);
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), _, _));
+    deliveries[0](std::error_code(), whole.to_string().size(), whole.to_string().data());
+    Mock::VerifyAndClearExpectations(&response_handler_mock);
+
+    // The second hits, and Riak confirms the object unchanged.
+    cached.get_object("bucket", "key", response_handler);
+    ASSERT_EQ(2u, deliveries.size());
+    ASSERT_TRUE(message::retrieve(request, requests[1].size(), requests[1]));
+    EXPECT_EQ("clock", request.if_modified());
+
+    RpbGetResp unchanged;
+    unchanged.set_unchanged(true);
+    unchanged.SerializeToString(&response_data);
+    message::wire_package confirmation(message::code::GetResponse, response_data);
+    std::shared_ptr<object> value;
+    value_updater updater;
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), _, _))
+        .WillOnce(DoAll(SaveArg<1>(&value), SaveArg<2>(&updater)));
+    deliveries[1](std::error_code(), confirmation.to_string().size(), confirmation.to_string().data());
+
+    ASSERT_TRUE(!! value);
+    EXPECT_EQ("value", value->value());
+    EXPECT_EQ(1u, cache->hits());
+    EXPECT_EQ(1u, cache->misses());
+    EXPECT_EQ(5u, cache->bytes_saved());
+
+    // What the application does with its copy does not reach the cache.
+    value->set_value("altered");
+    updater(value, [] (const std::error_code&) {   });
+    ASSERT_EQ(3u, requests.size());
+    RpbPutReq put;
+    ASSERT_TRUE(message::retrieve(put, requests[2].size(), requests[2]));
+    EXPECT_EQ("clock", put.vclock());
+    EXPECT_EQ("value", cache->revalidate("bucket", "key", "clock")->value());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, put_returning_head_displaces_the_cached_object_rather_than_emptying_it)
+{
+    auto cache = std::make_shared<object_cache>(1024);
+    auto never_resolve = [] (const siblings&) { return std::shared_ptr<object>(); };
+    riak::client cached(std::bind(&mock::transport::device::deliver, &transport, _1, _2), never_resolve, ios,
+            client::failure_defaults, client::access_override_defaults, cache);
+
+    RpbGetResp response;
+    response.set_vclock("clock");
+    response.add_content()->set_value("value");
+    std::string response_data;
+    response.SerializeToString(&response_data);
+    message::wire_package whole(message::code::GetResponse, response_data);
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), _, _)).Times(2);
+    cached.get_object("bucket", "key", response_handler);
+    deliveries[0](std::error_code(), whole.to_string().size(), whole.to_string().data());
+
+    // Riak returns the stored object's metadata, with an empty value, under a new vector clock.
+    auto new_value = std::make_shared<object>();
+    new_value->set_value("new value");
+    cached.put_object("bucket", "key", new_value, std::string("clock"), put_returns::head, response_handler);
+    ASSERT_EQ(2u, deliveries.size());
+    RpbPutResp head;
+    head.set_vclock("new clock");
+    head.add_content()->set_value("");
+    head.SerializeToString(&response_data);
+    message::wire_package put_reply(message::code::PutResponse, response_data);
+    deliveries[1](std::error_code(), put_reply.to_string().size(), put_reply.to_string().data());
+    EXPECT_EQ(0u, cache->bytes_held());
+
+    // The next GET is unconditional, so that Riak sends the value in full.
+    cached.get_object("bucket", "key", response_handler);
+    ASSERT_EQ(3u, requests.size());
+    RpbGetReq request;
+    ASSERT_TRUE(message::retrieve(request, requests[2].size(), requests[2]));
+    EXPECT_FALSE(request.has_if_modified());
+
+    response.set_vclock("new clock");
+    response.mutable_content(0)->set_value("new value");
+    response.SerializeToString(&response_data);
+    message::wire_package fetched(message::code::GetResponse, response_data);
+    std::shared_ptr<object> value;
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), _, _))
+        .WillOnce(SaveArg<1>(&value));
+    deliveries[2](std::error_code(), fetched.to_string().size(), fetched.to_string().data());
+    ASSERT_TRUE(!! value);
+    EXPECT_EQ("new value", value->value());
+    EXPECT_EQ("new value", cache->revalidate("bucket", "key", "new clock")->value());
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
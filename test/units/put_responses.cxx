@@ -78,7 +78,7 @@ TEST_F(get_and_put_client, client_receives_socket_errors_from_object_update)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -95,7 +95,7 @@ TEST_F(get_and_put_client, client_receives_socket_errors_from_object_update)
     EXPECT_CALL(put_response_handler_mock, execute(Eq(std::make_error_code(std::errc::connection_reset))));
     EXPECT_CALL(close_request_2, exercise()).Times(1);
     std::string garbage("uhetnaoutaenosueosaueoas");
-    request_handler_2(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage);
+    request_handler_2(std::make_error_code(std::errc::connection_reset), garbage.size(), garbage.data());
 }
 
 
@@ -111,7 +111,7 @@ TEST_F(get_and_put_client, client_survives_wrong_code_reply_upon_object_update)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -128,7 +128,7 @@ TEST_F(get_and_put_client, client_survives_wrong_code_reply_upon_object_update)
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code(communication_failure::unparseable_response))));
     EXPECT_CALL(close_request_2, exercise()).Times(1);
     riak::message::wire_package bad_reply(riak::message::code::GetResponse /* should be put */, "something");
-    request_handler_2(riak::make_error_code(), bad_reply.to_string().size(), bad_reply.to_string());
+    request_handler_2(riak::make_error_code(), bad_reply.to_string().size(), bad_reply.to_string().data());
 }
 
 
@@ -144,7 +144,7 @@ TEST_F(get_and_put_client, empty_server_replies_to_object_update_are_buffered)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -169,7 +169,7 @@ TEST_F(get_and_put_client, put_for_cold_object_with_well_formed_response_is_succ
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -179,7 +179,7 @@ TEST_F(get_and_put_client, put_for_cold_object_with_well_formed_response_is_succ
     // Respond from server.
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code())));
     EXPECT_CALL(close_request_2, exercise()).Times(1);
-    request_handler_2(std::error_code(), clean_put_reply().size(), clean_put_reply());
+    request_handler_2(std::error_code(), clean_put_reply().size(), clean_put_reply().data());
 }
 
 
@@ -195,7 +195,7 @@ TEST_F(get_and_put_client, client_survives_long_nonsense_reply_to_cold_put)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -206,7 +206,7 @@ TEST_F(get_and_put_client, client_survives_long_nonsense_reply_to_cold_put)
     std::string garbage("uhetnaoutaenosueosaueoas");
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code()))).Times(0);
     EXPECT_CALL(close_request_2, exercise()).Times(0);
-    request_handler_2(std::error_code(), garbage.size(), garbage);
+    request_handler_2(std::error_code(), garbage.size(), garbage.data());
     
 }
 
@@ -223,7 +223,7 @@ TEST_F(get_and_put_client, client_survives_extra_data_in_cold_put_response)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response.
     auto val = std::make_shared<object>();
@@ -234,7 +234,7 @@ TEST_F(get_and_put_client, client_survives_extra_data_in_cold_put_response)
     std::string long_reply = clean_put_reply() + "aueoauseonsauenats";
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code())));
     EXPECT_CALL(close_request_2, exercise());
-    request_handler_2(std::error_code(), long_reply.size(), long_reply);
+    request_handler_2(std::error_code(), long_reply.size(), long_reply.data());
 }
 
 
@@ -250,7 +250,7 @@ TEST_F(get_and_put_client, client_accepts_well_formed_put_response_in_parts)
             _))
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
-    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+    request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
     // Proceed with PUT response from client.
     auto val = std::make_shared<object>();
@@ -266,12 +266,12 @@ TEST_F(get_and_put_client, client_accepts_well_formed_put_response_in_parts)
     // ... part 1
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code()))).Times(0);
     EXPECT_CALL(close_request_2, exercise()).Times(0);
-    request_handler_2(std::error_code(), first_half.size(), first_half);
+    request_handler_2(std::error_code(), first_half.size(), first_half.data());
 
     // ... part 2
     EXPECT_CALL(put_response_handler_mock, execute(Eq(riak::make_error_code())));
     EXPECT_CALL(close_request_2, exercise());
-    request_handler_2(std::error_code(), second_half.size(), second_half);
+    request_handler_2(std::error_code(), second_half.size(), second_half.data());
 }
 
 
@@ -291,7 +291,7 @@ TEST_F(get_and_put_client, client_correctly_delivers_put_reply_with_vector_clock
         .WillOnce(SaveArg<2>(&update_value));
     EXPECT_CALL(close_request_1, exercise()).Times(1);
     const auto content_laden_reply_data = as_wire_request_data(original_get_response, riak::message::code::GetResponse);
-    request_handler_1(std::error_code(), content_laden_reply_data.size(), content_laden_reply_data);
+    request_handler_1(std::error_code(), content_laden_reply_data.size(), content_laden_reply_data.data());
 
     // Proceed with PUT response from client.
     const std::string& put_request_to_server = received_request_2;
@@ -332,7 +332,7 @@ TEST_F(get_and_put_client, client_correctly_delivers_put_reply_with_vector_clock
                 .WillOnce(SaveArg<2>(&update_value));
         EXPECT_CALL(close_request_1, exercise())
                 .Times(AnyNumber());
-        request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply());
+        request_handler_1(std::error_code(), clean_fetch_reply().size(), clean_fetch_reply().data());
 
         // Update the value: check that this yields a new request ID.
         const auto& original_record_attributes = original_get_log_record.attribute_values();
@@ -373,7 +373,7 @@ TEST_F(get_and_put_client, client_correctly_delivers_put_reply_with_vector_clock
         EXPECT_CALL(close_request_1, exercise())
                 .Times(AnyNumber());
         const auto fetch_reply_data = as_wire_request_data(fetch_reply, riak::message::code::GetResponse);
-        request_handler_1(std::error_code(), fetch_reply_data.size(), fetch_reply_data);
+        request_handler_1(std::error_code(), fetch_reply_data.size(), fetch_reply_data.data());
 
         // Update the value: check that this yields a new request ID.
         const auto& original_record_attributes = original_get_log_record.attribute_values();
@@ -0,0 +1,154 @@
+/*!
+ * \file
+ * Implements unit tests for the retry of requests which the network or server failed to answer,
+ * and for the hedging of those which it is slow to answer.
+ */
+#include <gtest/gtest.h>
+#include <boost/asio/deadline_timer.hpp>
+#include <riak/error.hxx>
+#include <riak/message.hxx>
+#include <test/fixtures/riak-client-with-mocked-transport.hxx>
+#include <system_error>
+
+using namespace ::testing;
+using riak::test::fixture::riak_client_with_mocked_transport;
+
+//=============================================================================
+namespace riak {
+    namespace test {
+        namespace {
+//=============================================================================
+
+/*!
+ * \return two retries per request, with a negligible backoff, and hedging of GETs slower than
+ *     the 95th percentile.
+ */
+request_failure_parameters retrying ()
+{
+    return client::failure_defaults
+        .with_retries_permitted(2)
+        .with_retry_backoff(std::chrono::milliseconds(1))
+        .with_request_deadline(std::chrono::milliseconds(0))
+        .with_hedge_percentile(95);
+}
+
+//=============================================================================
+        }   // namespace (anonymous)
+//=============================================================================
+
+TEST_F(riak_client_with_mocked_transport, get_is_retried_after_a_network_failure)
+{
+    start(retrying());
+    EXPECT_CALL(transport, deliver(_, _)).Times(2);
+    EXPECT_CALL(closure_signal, exercise()).Times(2);
+    EXPECT_CALL(response_handler_mock, execute(Eq(riak::make_error_code()), IsNull(), _));
+
+    client->get_object("a", "document", response_handler);
+    ASSERT_EQ(1u, deliveries.size());
+    deliveries[0](std::make_error_code(std::errc::connection_reset), 0, "");
+
+    // The retry is sent only after a backoff.
+    EXPECT_EQ(1u, deliveries.size());
+    run_until_next_delivery();
+    ASSERT_EQ(2u, deliveries.size());
+
+    std::string response_data;
+    RpbGetResp().SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+    deliveries[1](std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
+}
+
+
+TEST_F(riak_client_with_mocked_transport, delete_fails_once_retries_are_exhausted)
+{
+    start(retrying());
+    EXPECT_CALL(transport, deliver(_, _)).Times(3);
+    EXPECT_CALL(closure_signal, exercise()).Times(3);
+    EXPECT_CALL(delete_response_handler_mock, execute(Eq(std::make_error_code(std::errc::connection_reset))));
+
+    client->delete_object("a", "document", delete_response_handler);
+    for (std::size_t attempt = 0; attempt < 3; ++attempt) {
+        ASSERT_EQ(attempt + 1, deliveries.size());
+        deliveries[attempt](std::make_error_code(std::errc::connection_reset), 0, "");
+        run_until_next_delivery();
+    }
+}
+
+
+TEST_F(riak_client_with_mocked_transport, garbled_responses_are_not_retried)
+{
+    start(retrying());
+    EXPECT_CALL(transport, deliver(_, _)).Times(1);
+    EXPECT_CALL(closure_signal, exercise());
+    EXPECT_CALL(delete_response_handler_mock,
+            execute(Eq(riak::make_error_code(communication_failure::unparseable_response))));
+
+    client->delete_object("a", "document", delete_response_handler);
+    message::wire_package wrong_reply(message::code::GetResponse, "");
+    deliveries[0](std::error_code(), wrong_reply.to_string().size(), wrong_reply.to_string().data());
+    run_until_next_delivery();
+}
+
+
+TEST_F(riak_client_with_mocked_transport, retry_waits_for_its_response_no_longer_than_the_deadline_allows)
+{
+    start(retrying()
+        .with_response_timeout(std::chrono::hours(1))
+        .with_request_deadline(std::chrono::milliseconds(100)));
+    EXPECT_CALL(transport, deliver(_, _)).Times(2);
+    EXPECT_CALL(closure_signal, exercise()).Times(2);
+
+    boost::asio::deadline_timer give_up(ios);
+    EXPECT_CALL(response_handler_mock, execute(Eq(make_error_code(communication_failure::response_timeout)), _, _))
+        .WillOnce(InvokeWithoutArgs([&give_up] () { give_up.cancel(); }));
+
+    client->get_object("a", "document", response_handler);
+    deliveries[0](std::make_error_code(std::errc::connection_reset), 0, "");
+    run_until_next_delivery();
+    ASSERT_EQ(2u, deliveries.size());
+
+    // The retry would otherwise wait for an hour; the test gives up long before.
+    give_up.expires_from_now(boost::posix_time::seconds(5));
+    give_up.async_wait([this] (const boost::system::error_code& error) {
+        if (not error)
+            ios.stop();
+    });
+    ios.reset();
+    ios.run();
+}
+
+
+TEST_F(riak_client_with_mocked_transport, slow_get_is_hedged_and_the_first_response_wins)
+{
+    start(retrying());
+    std::string response_data;
+    RpbGetResp().SerializeToString(&response_data);
+    message::wire_package clean_reply(message::code::GetResponse, response_data);
+    auto answer = [&] (std::size_t delivery) {
+        deliveries[delivery](std::error_code(), clean_reply.to_string().size(), clean_reply.to_string().data());
+    };
+
+    // Until enough response times are known, nothing is hedged.
+    const std::size_t prompt_gets = 16;
+    EXPECT_CALL(response_handler_mock, execute(_, _, _)).Times(prompt_gets + 1);
+    for (std::size_t i = 0; i < prompt_gets; ++i) {
+        client->get_object("a", "document", response_handler);
+        ASSERT_EQ(i + 1, deliveries.size());
+        answer(i);
+    }
+
+    // The hedge goes out once the GET outlasts the others; the response to it wins.
+    EXPECT_CALL(closure_signal, exercise()).Times(2);
+    client->get_object("a", "document", response_handler);
+    run_until_next_delivery();
+    ASSERT_EQ(prompt_gets + 2, deliveries.size());
+    answer(prompt_gets + 1);
+
+    // The first request is left to finish; its response ends it, but is not used.
+    answer(prompt_gets);
+}
+
+//=============================================================================
+    }   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,95 @@
+/*!
+ * \file
+ * Implements unit tests for the caching of node addresses shared by the sockets of a pool.
+ */
+#include <gtest/gtest.h>
+#include <riak/transports/single_serial_socket/caching_resolver.hxx>
+#include <test/fixtures/single_socket_transport/reachable_node.hxx>
+#include <test/mocks/transport/single_serial_socket/resolver.hxx>
+#include <boost/asio/io_service.hpp>
+#include <string>
+#include <vector>
+
+using namespace ::testing;
+namespace single_serial_socket = ::riak::transport::single_serial_socket;
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace {
+//=============================================================================
+
+/*!
+ * Records the host name of every resolution reported to it.
+ */
+struct resolution_log
+{
+	void operator() (const boost::system::error_code& error, single_serial_socket::resolver::iterator endpoints) {
+		errors.push_back(error);
+		hosts.push_back(error ? "" : endpoints->host_name());
+	}
+
+	std::vector<boost::system::error_code> errors;
+	std::vector<std::string> hosts;
+};
+
+//=============================================================================
+		}   // namespace (anonymous)
+//=============================================================================
+
+TEST(resolution_cache, resolutions_under_way_together_share_one_lookup)
+{
+	boost::asio::io_service ios;
+	auto source = std::make_shared<StrictMock<mock::sss::resolver>>();
+	auto cache = std::make_shared<single_serial_socket::caching_resolver>(source, ios, std::chrono::milliseconds(60000));
+	single_serial_socket::resolver::query target("wherever", "8000");
+
+	single_serial_socket::resolver::ResolveHandler complete_lookup;
+	EXPECT_CALL(*source, async_resolve(_, _)).WillOnce(SaveArg<1>(&complete_lookup));
+	resolution_log log;
+	cache->async_resolve(target, std::ref(log));
+	cache->async_resolve(target, std::ref(log));
+	EXPECT_TRUE(log.hosts.empty());
+
+	complete_lookup(boost::system::error_code(), fixture::node_endpoints());
+	ASSERT_EQ(2u, log.hosts.size());
+	EXPECT_EQ("boo", log.hosts[1]);
+
+	// Later reconnections are answered from the cache.
+	cache->async_resolve(target, std::ref(log));
+	ios.poll();
+	ASSERT_EQ(3u, log.hosts.size());
+	EXPECT_EQ("boo", log.hosts[2]);
+}
+
+
+TEST(resolution_cache, expired_addresses_are_used_while_refreshed_in_the_background)
+{
+	boost::asio::io_service ios;
+	auto source = std::make_shared<StrictMock<mock::sss::resolver>>();
+	auto cache = std::make_shared<single_serial_socket::caching_resolver>(source, ios, std::chrono::milliseconds(0));
+	single_serial_socket::resolver::query target("wherever", "8000");
+
+	single_serial_socket::resolver::ResolveHandler complete_lookup;
+	EXPECT_CALL(*source, async_resolve(_, _)).Times(2).WillRepeatedly(SaveArg<1>(&complete_lookup));
+	resolution_log log;
+	cache->async_resolve(target, std::ref(log));
+	complete_lookup(boost::system::error_code(), fixture::node_endpoints());
+
+	// Only one refresh is needed, however many sockets reconnect meanwhile.
+	cache->async_resolve(target, std::ref(log));
+	cache->async_resolve(target, std::ref(log));
+	ios.poll();
+	ASSERT_EQ(3u, log.hosts.size());
+	EXPECT_EQ("boo", log.hosts[2]);
+
+	// A failed refresh is reported to nobody; the old addresses remain in use.
+	complete_lookup(boost::asio::error::host_not_found, single_serial_socket::resolver::iterator());
+	EXPECT_EQ(3u, log.hosts.size());
+	Mock::VerifyAndClearExpectations(source.get());
+}
+
+//=============================================================================
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,95 @@
+/*!
+ * \file
+ * Implements unit tests for the routing of requests among the shards of a sharded client.
+ */
+#include <gtest/gtest.h>
+#include <riak/message.hxx>
+#include <riak/sharded_client.hxx>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <string>
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace {
+//=============================================================================
+
+/*!
+ * Counts the responses handed out by a sharded client, and lets a test wait for them.
+ */
+struct response_count
+{
+	response_count ()
+	  : received(0)
+	{   }
+
+	void operator() (const std::error_code&, std::shared_ptr<object>&, value_updater) {
+		boost::unique_lock<boost::mutex> serialize(mutex);
+		++received;
+		changed.notify_all();
+	}
+
+	void wait_for (std::size_t n) {
+		boost::unique_lock<boost::mutex> serialize(mutex);
+		while (received < n)
+			changed.wait(serialize);
+	}
+
+	boost::mutex mutex;
+	boost::condition_variable changed;
+	std::size_t received;
+};
+
+std::shared_ptr<object> no_sibling_resolution (const siblings&)
+{
+	return std::make_shared<object>();
+}
+
+//=============================================================================
+		}   // namespace (anonymous)
+//=============================================================================
+
+TEST(sharded_client, requests_for_one_key_are_always_served_by_its_shard)
+{
+	// Every shard finds nothing under any key, and counts the requests it served.
+	std::atomic<std::size_t> served[2];
+	served[0] = 0;
+	served[1] = 0;
+	const std::string not_found = message::wire_package(message::code::GetResponse, std::string()).release();
+	std::size_t shards_made = 0;
+	auto make_transport = [&served, &shards_made, not_found] (boost::asio::io_service& ios) -> transport::delivery_provider {
+		std::size_t shard = shards_made++;
+		return [&served, &ios, shard, not_found] (const std::string&, transport::response_handler h) {
+			++served[shard];
+			ios.post([h, not_found] () { h(std::error_code(), not_found.size(), not_found.data()); });
+			return transport::option_to_terminate_request([] (bool) {   });
+		};
+	};
+	sharded_client store(make_transport, &no_sibling_resolution, 2);
+	ASSERT_EQ(2u, shards_made);
+
+	// Find a key for each shard.
+	std::string keys[2];
+	for (std::size_t i = 0; keys[0].empty() or keys[1].empty(); ++i) {
+		auto k = boost::lexical_cast<std::string>(i);
+		keys[store.shard_of("bucket", k)] = k;
+	}
+
+	response_count responses;
+	for (int i = 0; i < 3; ++i) {
+		store.get_object("bucket", keys[0], std::ref(responses));
+		store.get_object("bucket", keys[1], std::ref(responses));
+	}
+	store.get_object("bucket", keys[1], std::ref(responses));
+	responses.wait_for(7);
+	EXPECT_EQ(3u, served[0]);
+	EXPECT_EQ(4u, served[1]);
+}
+
+//=============================================================================
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -50,7 +50,7 @@ TEST_F(get_with_siblings, getting_siblinged_value_triggers_resolution)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 }
 
 
@@ -70,7 +70,7 @@ TEST_F(get_with_siblings, null_resolution_result_yields_a_nonerror_result)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 }
 
 
@@ -89,7 +89,7 @@ TEST_F(get_with_siblings, value_update_after_null_resolution_produces_new_siblin
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
     // Prepare to capture a PUT to the server
     std::string second_request_to_server;
@@ -138,7 +138,7 @@ TEST_F(get_with_siblings, resolved_sibling_is_returned_to_server)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
     // Check that the following PUT contained the expected sibling.
     if (not second_request_to_server.empty()) {
@@ -176,7 +176,7 @@ TEST_F(get_with_siblings, resolved_sibling_produces_get_result)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
     // Check that the following PUT contained the expected sibling.
     if (not second_request_to_server.empty()) {
@@ -200,7 +200,7 @@ TEST_F(get_with_siblings, resolved_sibling_produces_get_result)
             std::string encoded_response;
             put_response.SerializeToString(&encoded_response);
             riak::message::wire_package wire_response(riak::message::code::PutResponse, encoded_response);
-            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
         } else {
             ADD_FAILURE() << "Sibling resolution produced something other than a PUT request to the server!";
         }
@@ -229,7 +229,7 @@ TEST_F(get_with_siblings, resolving_sibling_handles_erroneous_server_reply)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
     // Now the server misbehaves with the PUT response.
     if (not second_request_to_server.empty()) {
@@ -243,7 +243,7 @@ TEST_F(get_with_siblings, resolving_sibling_handles_erroneous_server_reply)
             std::string encoded_response;
             put_response.SerializeToString(&encoded_response);   // Notice: wrong code!
             riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
         } else {
             ADD_FAILURE() << "Sibling resolution produced something other than a PUT request to the server!";
         }
@@ -272,7 +272,7 @@ TEST_F(get_with_siblings, resolving_sibling_handles_server_failure)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package wire_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+    send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
     // Now the server misbehaves with the PUT response.
     if (not second_request_to_server.empty()) {
@@ -308,7 +308,7 @@ TEST_F(get_with_siblings, multiple_sibling_resolutions_are_correctly_handled)
     std::string encoded_response;
     multi_value_get_response().SerializeToString(&encoded_response);
     riak::message::wire_package multisibling_response(riak::message::code::GetResponse, encoded_response);
-    send_from_server(std::error_code(), multisibling_response.to_string().size(), multisibling_response.to_string());
+    send_from_server(std::error_code(), multisibling_response.to_string().size(), multisibling_response.to_string().data());
 
     // Respond to the resolved sibling with more siblings, causing another PUT requset
     if (not second_request_to_server.empty()) {
@@ -341,7 +341,7 @@ TEST_F(get_with_siblings, multiple_sibling_resolutions_are_correctly_handled)
             std::string encoded_response;
             put_response.SerializeToString(&encoded_response);
             riak::message::wire_package wire_response(riak::message::code::PutResponse, encoded_response);
-            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
 
             if (not third_request_to_server.empty()) {
                 RpbGetReq second_get_request;   // A PUT would have returned only heads, so another GET is needed.
@@ -360,7 +360,7 @@ TEST_F(get_with_siblings, multiple_sibling_resolutions_are_correctly_handled)
                     send_from_server(
                             std::error_code(),
                             multisibling_response.to_string().size(),
-                            multisibling_response.to_string());
+                            multisibling_response.to_string().data());
                     
                     if (not fourth_request_to_server.empty()) {
                         RpbPutReq second_put_request;
@@ -383,7 +383,7 @@ TEST_F(get_with_siblings, multiple_sibling_resolutions_are_correctly_handled)
                             std::string encoded_response;
                             put_response.SerializeToString(&encoded_response);
                             riak::message::wire_package wire_response(riak::message::code::PutResponse, encoded_response);
-                            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string());
+                            send_from_server(std::error_code(), wire_response.to_string().size(), wire_response.to_string().data());
                         } else {
                             ADD_FAILURE() << "Second-round sibling resolution produced something other than a PUT!";                    
                         }
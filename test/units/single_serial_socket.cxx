@@ -8,7 +8,7 @@
 #include <riak/transports/single_serial_socket/scheduler.hxx>
 #include <test/fixtures/single_socket_transport/single_serial_socket_transport_with_working_connection.hxx>
 #include <test/mocks/transport.hxx>
-#include <ostream>
+#include <boost/asio/buffer.hpp>
 #include <system_error>
 #include <boost/bind.hpp>
 
@@ -52,9 +52,8 @@ class DeliverResponseMessage
 	  , ios_(ios)
 	{   }
 
-	void operator() (boost::asio::streambuf& b, transport::single_serial_socket::socket::ReadHandler h) {
-		std::ostream stream(&b);
-		stream << content_;
+	void operator() (const boost::asio::mutable_buffer& b, transport::single_serial_socket::socket::ReadHandler h) {
+		boost::asio::buffer_copy(b, boost::asio::buffer(content_));
 
 		// std::bind yielded a stack overflow here.
 		std::function<void()> f = boost::bind(h, boost::system::error_code(), content_.length());
@@ -87,7 +86,7 @@ class YieldError
 	boost::asio::io_service& ios_;
 };
 
-typedef YieldError<boost::asio::streambuf> YieldErrorOnRead;
+typedef YieldError<const boost::asio::mutable_buffer> YieldErrorOnRead;
 typedef YieldError<const boost::asio::const_buffer> YieldErrorOnWrite;
 
 // in the shape of transport::response_handler
@@ -140,7 +139,7 @@ TEST_F(single_serial_socket_transport_with_working_connection, complete_response
 
 	// The meat of the test!
 	mock::transport::device::response_handler handler;
-	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::execute, &handler, _1, _2, _3));
+	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
 	auto error_code = make_std_error_code(boost::system::error_code().value());
 	EXPECT_CALL(handler, execute(error_code, expected_response.size(), Eq(expected_response)))
 		.WillOnce(Invoke(InvokeTerminateOption(t)));
@@ -161,7 +160,7 @@ TEST_F(single_serial_socket_transport_with_working_connection, connection_failur
 
 	// Make sure we get this error at the handler.
 	mock::transport::device::response_handler handler;
-	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::execute, &handler, _1, _2, _3));
+	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
 	auto error_code = make_std_error_code(boost::asio::error::connection_reset);
 	EXPECT_CALL(handler, execute(error_code, 0, "")).WillOnce(Invoke(InvokeTerminateOption(t)));
 
@@ -177,7 +176,7 @@ TEST_F(single_serial_socket_transport_with_working_connection, connection_failur
 
 	// Make sure we get this error at the handler.
 	mock::transport::device::response_handler handler;
-	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::execute, &handler, _1, _2, _3));
+	auto t = transport->deliver("what do mouse zombies like to eat?", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
 	auto error_code = make_std_error_code(boost::asio::error::connection_reset);
 	EXPECT_CALL(handler, execute(error_code, 0, "")).WillOnce(Invoke(InvokeTerminateOption(t)));
 
@@ -0,0 +1,621 @@
+/*!
+ * \file
+ * Implements unit tests for the sharing of one request queue among several connections of a
+ * single serial socket scheduler.
+ */
+#include <gtest/gtest.h>
+#include <riak/client.hxx>
+#include <riak/transports/single_serial_socket/scheduler.hxx>
+#include <test/fixtures/single_socket_transport/reachable_node.hxx>
+#include <test/fixtures/single_socket_transport/socket_pool_with_working_connections.hxx>
+#include <test/mocks/get_request.hxx>
+#include <test/mocks/transport.hxx>
+#include <riak/error.hxx>
+#include <boost/asio/buffer.hpp>
+#include <boost/thread/thread.hpp>
+#include <map>
+#include <system_error>
+
+using namespace ::testing;
+using riak::test::fixture::socket_pool_with_working_connections;
+namespace single_serial_socket = ::riak::transport::single_serial_socket;
+
+//=============================================================================
+namespace riak {
+	namespace test {
+		namespace {
+//=============================================================================
+
+MATCHER_P(HoldsBytes, expected, "")
+{
+	const char* bytes = boost::asio::buffer_cast<const char*>(arg);
+	return std::string(bytes, boost::asio::buffer_size(arg)) == expected;
+}
+
+/*!
+ * \return a Riak PBC frame holding the given message code and body.
+ */
+std::string frame (char code, const std::string& body)
+{
+	std::string result(4, '\0');
+	result[3] = static_cast<char>(body.size() + 1);
+	return result + code + body;
+}
+
+/*!
+ * Holds on to the last read issued on a socket, so that a test may complete it at will.
+ */
+struct pending_read
+{
+	// in the shape of async_read_some
+	void operator() (const boost::asio::mutable_buffer& b, single_serial_socket::socket::ReadHandler h) {
+		buffer = b;
+		handler = h;
+	}
+
+	// Places the bytes where a real socket would leave them.
+	void complete (const std::string& bytes) {
+		auto n = boost::asio::buffer_copy(buffer, boost::asio::buffer(bytes));
+		handler(boost::system::error_code(), n);
+	}
+
+	boost::asio::mutable_buffer buffer;
+	single_serial_socket::socket::ReadHandler handler;
+};
+
+//=============================================================================
+		}   // namespace (anonymous)
+//=============================================================================
+
+using std::placeholders::_1;
+using std::placeholders::_2;
+using std::placeholders::_3;
+
+TEST_F(socket_pool_with_working_connections, concurrent_requests_are_written_on_separate_sockets)
+{
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("first"), _));
+	EXPECT_CALL(*sockets[1], async_write_some(HoldsBytes("second"), _));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	auto t2 = transport->deliver("second", respond);
+	run_ready_handlers();
+}
+
+
+TEST_F(socket_pool_with_working_connections, queued_request_is_taken_by_first_free_socket)
+{
+	single_serial_socket::socket::WriteHandler complete_first_write;
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("first"), _))
+		.WillOnce(SaveArg<1>(&complete_first_write));
+	EXPECT_CALL(*sockets[1], async_write_some(HoldsBytes("second"), _));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	auto t2 = transport->deliver("second", respond);
+	auto t3 = transport->deliver("third", respond);
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+
+	// Only once the first request terminates cleanly may the third take its socket.
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("third"), _));
+	EXPECT_CALL(*sockets[1], async_write_some(_, _)).Times(0);
+	complete_first_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+	t1(false);
+	run_ready_handlers();
+}
+
+
+TEST_F(socket_pool_with_working_connections, dirty_termination_recycles_only_its_own_socket)
+{
+	single_serial_socket::socket::WriteHandler complete_first_write;
+	single_serial_socket::socket::ReadHandler complete_first_read;
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(SaveArg<1>(&complete_first_write));
+	ON_CALL(*sockets[0], async_read_some(_, _)).WillByDefault(SaveArg<1>(&complete_first_read));
+
+	NiceMock<mock::transport::device::response_handler> abandoned_handler;
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto t1 = transport->deliver("first", std::bind(&mock::transport::device::response_handler::receive, &abandoned_handler, _1, _2, _3));
+	auto t2 = transport->deliver("second", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
+	run_ready_handlers();
+	complete_first_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+
+	// The owner of the abandoned request must hear nothing further about it.
+	EXPECT_CALL(abandoned_handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(*sockets[0], cancel());
+	t1(true);
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+
+	EXPECT_CALL(*sockets[0], close()).Times(AtLeast(1));
+	EXPECT_CALL(*sockets[0], async_connect(_, _));
+	EXPECT_CALL(*sockets[1], close()).Times(0);
+	EXPECT_CALL(*sockets[1], async_connect(_, _)).Times(0);
+	complete_first_read(boost::asio::error::operation_aborted, 0);
+	run_ready_handlers();
+
+	// Shutdown of the pool closes everything; that is not under test.
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+}
+
+
+TEST_F(socket_pool_with_working_connections, responses_are_matched_to_requests_in_order_written)
+{
+	start(transport::pool_parameters().with_pipeline_depth(2));
+
+	single_serial_socket::socket::WriteHandler complete_write;
+	pending_read read;
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(SaveArg<1>(&complete_write));
+	ON_CALL(*sockets[0], async_read_some(_, _)).WillByDefault(Invoke(std::ref(read)));
+
+	transport::option_to_terminate_request t1, t3;
+	NiceMock<mock::transport::device::response_handler> first_handler, second_handler, third_handler;
+	t1 = transport->deliver("first", std::bind(&mock::transport::device::response_handler::receive, &first_handler, _1, _2, _3));
+	auto t2 = transport->deliver("second", std::bind(&mock::transport::device::response_handler::receive, &second_handler, _1, _2, _3));
+	run_ready_handlers();
+
+	// The third request need not wait for a response to the first to share its socket.
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("third"), _)).WillOnce(SaveArg<1>(&complete_write));
+	t3 = transport->deliver("third", std::bind(&mock::transport::device::response_handler::receive, &third_handler, _1, _2, _3));
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+
+	// Frames are delivered whole, even when they span reads.
+	const std::string first_response = frame(10, "cheesy");
+	const std::string third_response = frame(10, "brains!");
+	EXPECT_CALL(first_handler, execute(_, first_response.size(), first_response))
+		.WillOnce(InvokeWithoutArgs([&t1] () { t1(false); }));
+	EXPECT_CALL(third_handler, execute(_, third_response.size(), third_response))
+		.WillOnce(InvokeWithoutArgs([&t3] () { t3(false); }));
+	EXPECT_CALL(second_handler, execute(_, _, _)).Times(0);
+
+	const std::string received = first_response + third_response;
+	read.complete(received.substr(0, 13));
+	run_ready_handlers();
+	read.complete(received.substr(13));
+	run_ready_handlers();
+}
+
+
+TEST_F(socket_pool_with_working_connections, abandoning_a_request_in_flight_fails_the_requests_sharing_its_socket)
+{
+	start(transport::pool_parameters().with_pipeline_depth(2));
+
+	single_serial_socket::socket::WriteHandler complete_write;
+	pending_read read;
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(SaveArg<1>(&complete_write));
+	ON_CALL(*sockets[0], async_read_some(_, _)).WillByDefault(Invoke(std::ref(read)));
+
+	NiceMock<mock::transport::device::response_handler> first_handler, second_handler, third_handler;
+	auto t1 = transport->deliver("first", std::bind(&mock::transport::device::response_handler::receive, &first_handler, _1, _2, _3));
+	auto t2 = transport->deliver("second", std::bind(&mock::transport::device::response_handler::receive, &second_handler, _1, _2, _3));
+	auto t3 = transport->deliver("third", std::bind(&mock::transport::device::response_handler::receive, &third_handler, _1, _2, _3));
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+
+	// A reply to the third request may still arrive, and nothing behind it can be trusted.
+	EXPECT_CALL(*sockets[0], cancel());
+	t3(true);
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+
+	EXPECT_CALL(third_handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(first_handler, execute(std::make_error_code(std::errc::connection_aborted), 0, ""))
+		.WillOnce(InvokeWithoutArgs([&t1] () { t1(true); }));
+	EXPECT_CALL(second_handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(*sockets[0], async_connect(_, _));
+	EXPECT_CALL(*sockets[1], async_connect(_, _)).Times(0);
+	read.handler(boost::asio::error::operation_aborted, 0);
+	run_ready_handlers();
+
+	// Shutdown of the pool closes everything; that is not under test.
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+	Mock::VerifyAndClearExpectations(&second_handler);
+}
+
+
+TEST_F(socket_pool_with_working_connections, losing_hedge_is_left_to_finish_rather_than_failing_its_neighbours)
+{
+	start(transport::pool_parameters().with_pipeline_depth(2));
+
+	// Every write completes at once; reads wait for the test.
+	pending_read reads[2];
+	for (int i = 0; i < 2; ++i) {
+		ON_CALL(*sockets[i], async_write_some(_, _)).WillByDefault(Invoke(
+				[this] (const boost::asio::const_buffer& b, single_serial_socket::socket::WriteHandler h) {
+					ios.post(std::bind(h, boost::system::error_code(), boost::asio::buffer_size(b)));
+				}));
+		ON_CALL(*sockets[i], async_read_some(_, _)).WillByDefault(Invoke(std::ref(reads[i])));
+	}
+
+	auto no_resolution = [] (const siblings&) { return std::shared_ptr<object>(); };
+	riak::client client(std::bind(&single_serial_socket::scheduler::deliver, transport.get(), _1, _2), no_resolution, ios,
+			client::failure_defaults.with_retries_permitted(0).with_hedge_percentile(95));
+	NiceMock<mock::get_request::response_handler> get_handler;
+	auto respond_to_get = std::bind(&mock::get_request::response_handler::execute, &get_handler, _1, _2, _3);
+
+	// Until enough response times are known, nothing is hedged.
+	const std::string empty_get_response = frame(10, "");
+	for (int i = 0; i < 16; ++i) {
+		client.get_object("bucket", "key", respond_to_get);
+		run_ready_handlers();
+		reads[0].complete(empty_get_response);
+		run_ready_handlers();
+	}
+
+	// The slow GET is hedged on the idle socket, and an unrelated request is pipelined behind it.
+	bool hedged = false;
+	EXPECT_CALL(*sockets[1], async_write_some(_, _)).WillOnce(Invoke(
+			[this, &hedged] (const boost::asio::const_buffer& b, single_serial_socket::socket::WriteHandler h) {
+				hedged = true;
+				ios.post(std::bind(h, boost::system::error_code(), boost::asio::buffer_size(b)));
+			}));
+	client.get_object("bucket", "key", respond_to_get);
+	while (not hedged and ios.run_one() > 0)
+		;
+	ios.reset();
+	run_ready_handlers();
+	ASSERT_TRUE(hedged);
+
+	NiceMock<mock::transport::device::response_handler> neighbour;
+	auto t = transport->deliver(frame(13, "neighbour"), std::bind(&mock::transport::device::response_handler::receive, &neighbour, _1, _2, _3));
+	run_ready_handlers();
+
+	// The hedge wins. The first GET is not terminated dirty, which would fail its neighbour.
+	EXPECT_CALL(get_handler, execute(Eq(riak::make_error_code()), _, _));
+	EXPECT_CALL(*sockets[0], cancel()).Times(0);
+	reads[1].complete(empty_get_response);
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(&get_handler);
+	Mock::VerifyAndClearExpectations(sockets[0]);
+
+	// Its answer arrives in due course, and is discarded; the neighbour's follows as usual.
+	const std::string neighbour_response = frame(14, "");
+	EXPECT_CALL(get_handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(neighbour, execute(_, neighbour_response.size(), neighbour_response));
+	reads[0].complete(empty_get_response + neighbour_response);
+	run_ready_handlers();
+}
+
+
+TEST_F(socket_pool_with_working_connections, requests_wait_for_a_socket_reconnecting_after_refusal)
+{
+	single_serial_socket::socket::WriteHandler complete_first_write;
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("first"), _))
+		.WillOnce(SaveArg<1>(&complete_first_write));
+	EXPECT_CALL(*sockets[1], async_write_some(HoldsBytes("second"), _));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	auto t2 = transport->deliver("second", respond);
+	run_ready_handlers();
+
+	// The first socket drops, and the node refuses it once. Meanwhile, the second socket is busy.
+	auto refuse = [this] (const boost::asio::ip::basic_resolver_entry<boost::asio::ip::tcp>&, single_serial_socket::socket::ConnectHandler h) {
+		std::function<void()> f = std::bind(h, boost::asio::error::connection_refused);
+		ios.post(f);
+	};
+	EXPECT_CALL(*sockets[0], async_connect(_, _))
+		.WillOnce(Invoke(refuse))
+		.WillOnce(DoDefault());
+	complete_first_write(boost::asio::error::connection_reset, 0);
+	run_ready_handlers();
+	t1(true);
+	auto t3 = transport->deliver("third", respond);
+
+	// Once the backoff has passed, the socket connects again and takes the waiting request.
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("third"), _));
+	EXPECT_CALL(*sockets[1], async_write_some(_, _)).Times(0);
+	ios.run();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+}
+
+
+TEST_F(socket_pool_with_working_connections, requests_beyond_the_queue_limit_are_rejected)
+{
+	start(transport::pool_parameters().with_queue_limit(1, transport::overload_policy::reject));
+
+	NiceMock<mock::transport::device::response_handler> handler, rejected_handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	run_ready_handlers();
+	auto t2 = transport->deliver("second", respond);
+	run_ready_handlers();
+	EXPECT_EQ(0u, transport->queued_requests());
+
+	// Both sockets are busy, so the third request waits, and there is no room for a fourth.
+	EXPECT_CALL(handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(rejected_handler, execute(make_error_code(communication_failure::overloaded), 0, ""));
+	auto t3 = transport->deliver("third", respond);
+	auto t4 = transport->deliver("fourth", std::bind(&mock::transport::device::response_handler::receive, &rejected_handler, _1, _2, _3));
+	run_ready_handlers();
+	EXPECT_EQ(1u, transport->queued_requests());
+
+	// Withdrawing the waiting request makes room again.
+	t3(false);
+	EXPECT_EQ(0u, transport->queued_requests());
+}
+
+
+TEST_F(socket_pool_with_working_connections, full_blocking_queue_rejects_requests_delivered_by_its_own_handlers)
+{
+	start(transport::pool_parameters().with_queue_limit(1, transport::overload_policy::block));
+
+	NiceMock<mock::transport::device::response_handler> handler, rejected_handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	run_ready_handlers();
+	auto t2 = transport->deliver("second", respond);
+	run_ready_handlers();
+	auto t3 = transport->deliver("third", respond);
+	run_ready_handlers();
+	ASSERT_EQ(1u, transport->queued_requests());
+
+	// Waiting here would stop ios from ever making room.
+	EXPECT_CALL(rejected_handler, execute(make_error_code(communication_failure::overloaded), 0, ""));
+	transport::option_to_terminate_request t4;
+	ios.post([&] () {
+		t4 = transport->deliver("fourth", std::bind(&mock::transport::device::response_handler::receive, &rejected_handler, _1, _2, _3));
+	});
+	run_ready_handlers();
+	run_ready_handlers();
+	EXPECT_EQ(1u, transport->queued_requests());
+}
+
+
+TEST_F(socket_pool_with_working_connections, destruction_waits_for_requests_blocked_on_a_full_queue)
+{
+	start(transport::pool_parameters().with_queue_limit(1, transport::overload_policy::block));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	run_ready_handlers();
+	auto t2 = transport->deliver("second", respond);
+	run_ready_handlers();
+	auto t3 = transport->deliver("third", respond);
+	run_ready_handlers();
+
+	bool halted = false;
+	boost::thread submitter([&] () {
+		try {
+			transport->deliver("fourth", respond);
+		} catch (const std::system_error&) {
+			halted = true;
+		}
+	});
+	boost::this_thread::sleep(boost::posix_time::milliseconds(20));
+
+	transport.reset();
+	submitter.join();
+	EXPECT_TRUE(halted);
+}
+
+TEST_F(socket_pool_with_working_connections, request_waiting_past_its_deadline_is_dropped_rather_than_sent)
+{
+	start(transport::pool_parameters().with_max_queue_wait(std::chrono::milliseconds(1)));
+
+	single_serial_socket::socket::WriteHandler complete_first_write;
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes("first"), _))
+		.WillOnce(SaveArg<1>(&complete_first_write));
+
+	NiceMock<mock::transport::device::response_handler> handler, late_handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver("first", respond);
+	auto t2 = transport->deliver("second", respond);
+	auto t3 = transport->deliver("third", std::bind(&mock::transport::device::response_handler::receive, &late_handler, _1, _2, _3));
+	run_ready_handlers();
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	boost::this_thread::sleep(boost::posix_time::milliseconds(5));
+
+	// The first socket frees up too late for the third request.
+	EXPECT_CALL(*sockets[0], async_write_some(_, _)).Times(0);
+	EXPECT_CALL(late_handler, execute(make_error_code(communication_failure::response_timeout), 0, ""));
+	complete_first_write(boost::system::error_code(), 5);
+	run_ready_handlers();
+	t1(false);
+	run_ready_handlers();
+	EXPECT_EQ(0u, transport->queued_requests());
+}
+
+TEST_F(socket_pool_with_working_connections, classes_take_turns_in_proportion_to_their_weights)
+{
+	std::vector<std::size_t> three_to_one;
+	three_to_one.push_back(3);
+	three_to_one.push_back(1);
+	start(transport::pool_parameters().with_priority_classes(three_to_one));
+
+	std::vector<std::string> written;
+	single_serial_socket::socket::WriteHandler complete_write;
+	auto record_write = [&written, &complete_write] (const boost::asio::const_buffer& b, single_serial_socket::socket::WriteHandler h) {
+		written.push_back(std::string(boost::asio::buffer_cast<const char*>(b), boost::asio::buffer_size(b)));
+		complete_write = h;
+	};
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(Invoke(record_write));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	std::map<std::string, transport::option_to_terminate_request> terminate;
+	terminate["busy"] = transport->deliver_as(0, "busy", respond);
+	terminate["also busy"] = transport->deliver_as(0, "also busy", respond);
+	run_ready_handlers();
+
+	// The batch requests were delivered first, but do not hold up the rest.
+	const char* batch[] = { "b1", "b2" };
+	const char* interactive[] = { "i1", "i2", "i3" };
+	for (auto r = std::begin(batch); r != std::end(batch); ++r)
+		terminate[*r] = transport->deliver_as(1, *r, respond);
+	for (auto r = std::begin(interactive); r != std::end(interactive); ++r)
+		terminate[*r] = transport->deliver_as(0, *r, respond);
+	run_ready_handlers();
+	EXPECT_EQ(3u, transport->queued_requests(0));
+	EXPECT_EQ(2u, transport->queued_requests(1));
+
+	for (int i = 0; i < 5; ++i) {
+		complete_write(boost::system::error_code(), written.back().size());
+		run_ready_handlers();
+		terminate[written.back()](false);
+		run_ready_handlers();
+	}
+
+	const char* expected[] = { "busy", "i1", "i2", "b1", "i3", "b2" };
+	EXPECT_EQ(std::vector<std::string>(std::begin(expected), std::end(expected)), written);
+	EXPECT_EQ(0u, transport->queued_requests());
+}
+
+
+TEST_F(socket_pool_with_working_connections, abandoned_request_is_answered_into_the_void_and_its_socket_reused)
+{
+	start(transport::pool_parameters().with_drain_timeout(std::chrono::milliseconds(1000)));
+
+	const std::string abandoned_get = frame(9, "first"), second_get = frame(9, "second"), third_get = frame(9, "third");
+	single_serial_socket::socket::WriteHandler complete_write;
+	pending_read read;
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(SaveArg<1>(&complete_write));
+	ON_CALL(*sockets[0], async_read_some(_, _)).WillByDefault(Invoke(std::ref(read)));
+
+	NiceMock<mock::transport::device::response_handler> abandoned_handler, handler;
+	auto respond = std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3);
+	auto t1 = transport->deliver(abandoned_get, std::bind(&mock::transport::device::response_handler::receive, &abandoned_handler, _1, _2, _3));
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), abandoned_get.size());
+	run_ready_handlers();
+
+	// Timing out leaves the socket alone; it is merely busy until the response arrives.
+	EXPECT_CALL(*sockets[0], cancel()).Times(0);
+	EXPECT_CALL(*sockets[0], close()).Times(0);
+	EXPECT_CALL(*sockets[0], async_connect(_, _)).Times(0);
+	EXPECT_CALL(*sockets[1], async_write_some(HoldsBytes(second_get), _));
+	t1(true);
+	auto t2 = transport->deliver(second_get, respond);
+	run_ready_handlers();
+
+	EXPECT_CALL(abandoned_handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(*sockets[0], async_write_some(HoldsBytes(third_get), _));
+	read.complete(frame(10, "stale"));
+	run_ready_handlers();
+	auto t3 = transport->deliver(third_get, respond);
+	run_ready_handlers();
+
+	// Shutdown of the pool closes everything; that is not under test.
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+}
+
+
+TEST_F(socket_pool_with_working_connections, request_terminated_off_its_strand_hears_nothing_already_received)
+{
+	start(transport::pool_parameters().with_drain_timeout(std::chrono::milliseconds(1000)));
+
+	const std::string get = frame(9, "first");
+	single_serial_socket::socket::WriteHandler complete_write;
+	pending_read read;
+	ON_CALL(*sockets[0], async_write_some(_, _)).WillByDefault(SaveArg<1>(&complete_write));
+	ON_CALL(*sockets[0], async_read_some(_, _)).WillByDefault(Invoke(std::ref(read)));
+
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto t1 = transport->deliver(get, std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
+	run_ready_handlers();
+	complete_write(boost::system::error_code(), get.size());
+	run_ready_handlers();
+
+	// The response is handed out on the strand before the termination is settled there.
+	EXPECT_CALL(handler, execute(_, _, _)).Times(0);
+	EXPECT_CALL(*sockets[0], cancel()).Times(0);
+	read.complete(frame(10, "late"));
+	t1(true);
+	run_ready_handlers();
+
+	// Shutdown of the pool closes everything; that is not under test.
+	Mock::VerifyAndClearExpectations(sockets[0]);
+	Mock::VerifyAndClearExpectations(sockets[1]);
+}
+
+
+TEST(warmed_up_socket_pool,connection_takes_requests_only_once_its_ping_is_answered)
+{
+	boost::asio::io_service ios;
+	auto resolver = std::make_shared<NiceMock<mock::sss::resolver>>();
+	fixture::resolve_successfully(*resolver, ios);
+	auto socket = new NiceMock<mock::sss::socket>;
+	fixture::connect_successfully(*socket, ios);
+
+	single_serial_socket::socket::WriteHandler complete_write;
+	pending_read read;
+	EXPECT_CALL(*socket, async_write_some(HoldsBytes(frame(1, "")), _)).WillOnce(SaveArg<1>(&complete_write));
+	ON_CALL(*socket, async_read_some(_, _)).WillByDefault(Invoke(std::ref(read)));
+
+	single_serial_socket::scheduler transport(
+			"wherever", 8000, ios,
+			std::unique_ptr<single_serial_socket::socket>(socket),
+			std::static_pointer_cast<single_serial_socket::resolver>(resolver),
+			transport::pool_parameters().with_warm_up(true));
+	ios.poll();
+	ios.reset();
+
+	// The request waits behind the ping, even once the ping is written.
+	NiceMock<mock::transport::device::response_handler> handler;
+	auto t1 = transport.deliver("first", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
+	ios.poll();
+	ios.reset();
+	complete_write(boost::system::error_code(), 5);
+	ios.poll();
+	ios.reset();
+	Mock::VerifyAndClearExpectations(socket);
+
+	EXPECT_CALL(*socket, async_write_some(HoldsBytes("first"), _));
+	read.complete(frame(2, ""));
+	ios.poll();
+	ios.reset();
+	Mock::VerifyAndClearExpectations(socket);
+}
+
+
+TEST(destroyed_socket_pool, work_left_on_the_io_service_does_nothing)
+{
+	boost::asio::io_service ios;
+	auto resolver = std::make_shared<NiceMock<mock::sss::resolver>>();
+	fixture::resolve_successfully(*resolver, ios);
+	auto socket = new NiceMock<mock::sss::socket>;
+	fixture::connect_successfully(*socket, ios);
+
+	std::unique_ptr<single_serial_socket::scheduler> transport(
+			new single_serial_socket::scheduler(
+					"wherever", 8000, ios,
+					std::unique_ptr<single_serial_socket::socket>(socket),
+					std::static_pointer_cast<single_serial_socket::resolver>(resolver),
+					transport::pool_parameters().with_keepalive_interval(std::chrono::milliseconds(1))));
+	ios.poll();
+	ios.reset();
+
+	// The request is delivered, but not yet taken from the submission queue.
+	NiceMock<mock::transport::device::response_handler> handler;
+	EXPECT_CALL(handler, execute(Eq(std::make_error_code(std::errc::network_reset)), _, _));
+	auto t1 = transport->deliver("first", std::bind(&mock::transport::device::response_handler::receive, &handler, _1, _2, _3));
+	transport.reset();
+
+	ios.poll();
+	t1(true);
+}
+
+//=============================================================================
+	}   // namespace test
+}   // namespace riak
+//=============================================================================
@@ -0,0 +1,52 @@
+/*!
+ * \file
+ * Implements unit tests for the lock-free queue through which requests reach a socket pool.
+ */
+#include <gtest/gtest.h>
+#include <riak/transports/single_serial_socket/submission_queue.hxx>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+//=============================================================================
+namespace riak {
+	namespace test {
+//=============================================================================
+
+TEST(submission_queue, items_are_taken_in_the_order_each_producer_pushed_them)
+{
+	transport::single_serial_socket::submission_queue<int> queue;
+	EXPECT_TRUE(queue.push(0));
+	EXPECT_FALSE(queue.push(1));
+	auto taken = queue.take_all();
+	ASSERT_EQ(2u, taken.size());
+	EXPECT_EQ(0, taken[0]);
+	EXPECT_EQ(1, taken[1]);
+
+	// Four producers push at once, while the consumer keeps taking.
+	const int per_producer = 10000;
+	boost::thread_group producers;
+	for (int p = 0; p < 4; ++p)
+		producers.create_thread([&queue, p, per_producer] () {
+			for (int i = 0; i < per_producer; ++i)
+				queue.push(p * per_producer + i);
+		});
+
+	std::vector<int> last_seen(4, -1);
+	std::size_t total = 0;
+	while (total < 4 * per_producer) {
+		auto batch = queue.take_all();
+		for (auto i = batch.begin(); i != batch.end(); ++i) {
+			int producer = *i / per_producer;
+			EXPECT_LT(last_seen[producer], *i);
+			last_seen[producer] = *i;
+		}
+		total += batch.size();
+	}
+	producers.join_all();
+	EXPECT_TRUE(queue.take_all().empty());
+}
+
+//=============================================================================
+	}   // namespace test
+}   // namespace riak
+//=============================================================================